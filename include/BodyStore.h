@@ -0,0 +1,29 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <vector>
+
+#include "Physics.h"
+
+/**
+ * Structure-of-Arrays storage for Bodies. Each attribute lives in its own
+ *  contiguous array so the force and integration loops stream through
+ *  tightly packed memory. Body i is the i-th element of every array.
+ */
+class BodyStore {
+  public:         // Body Attributes
+    std::vector<double>     x, y;                               // Position
+    std::vector<double>     vx, vy;                             // Velocity
+    std::vector<double>     ax, ay;                             // Acceleration
+    std::vector<double>     mass;
+    std::vector<double>     radius;
+
+  public:         // Public Functions
+    // Appends a body, returning its index.
+    size_t add(Vector2D pos, double mass, double radius, Vector2D velocity, Vector2D acceleration);
+
+    void reserve(size_t);                                       // Reserves Space for Bodies
+    void clear();                                               // Removes all Bodies
+    size_t size() const;                                        // Returns Number of Bodies
+};
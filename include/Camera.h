@@ -0,0 +1,63 @@
+#pragma once
+
+// Library Includes
+#include <cstdint>
+
+/**
+ * 2D Camera mapping world coordinates to screen pixels. The world point
+ *  at the top-left of the screen is the origin, and one world unit spans
+ *  zoom pixels. The default camera maps world to screen one to one.
+ *
+ * The visible world rectangle is kept up to date, so culling a primitive
+ *  is a handful of comparisons.
+ */
+class Camera {
+  public:         // Public Constants
+    static constexpr double MIN_ZOOM = 1e-4;
+    static constexpr double MAX_ZOOM = 1e4;
+
+  private:        // Private Variables
+    double          origin_x, origin_y;                         // World Point at Screen (0, 0)
+    double          zoom;                                       // Pixels per World Unit
+    int             width, height;                              // Viewport in Pixels
+    double          view_left, view_top;                        // Visible World Rectangle
+    double          view_right, view_bottom;
+    uint64_t        revision;                                   // Bumped on every Transform Change
+
+  private:        // Private Functions
+    void update_view();                                         // Recomputes the Visible Rectangle
+
+  public:         // Public Functions
+    void set_viewport(int width, int height);                   // Screen Size in Pixels
+    void look_at(double x, double y);                           // Centers the World Point
+    void pan(double dx, double dy);                             // Moves the View by Screen Pixels
+    void zoom_at(double factor, double sx, double sy);          // Zooms, Keeping the Screen Point Fixed
+    void reset();                                               // Back to One to One
+
+    inline void to_screen(double x, double y, double &sx, double &sy) const {
+      sx = (x - origin_x) * zoom;
+      sy = (y - origin_y) * zoom;
+    }
+
+    inline void to_world(double sx, double sy, double &x, double &y) const {
+      x = origin_x + sx / zoom;
+      y = origin_y + sy / zoom;
+    }
+
+    // If any of the world rectangle [x0, x1] x [y0, y1] is on screen.
+    inline bool is_visible(double x0, double y0, double x1, double y1) const {
+      return x1 >= view_left && x0 <= view_right && y1 >= view_top && y0 <= view_bottom;
+    }
+
+    // If any of a world circle (or anything within radius of the point) is on screen.
+    inline bool is_visible(double x, double y, double radius) const {
+      return is_visible(x - radius, y - radius, x + radius, y + radius);
+    }
+
+    double get_zoom() const;
+    uint64_t get_revision() const;                              // Changes whenever the Mapping does
+    void get_view(double &left, double &top, double &right, double &bottom) const;  // Visible World Rectangle
+
+  public:         // Constructor
+    Camera();
+};
@@ -2,39 +2,73 @@
 
 // Library Includes
 #include <gtkmm.h>
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+#include "DensityImage.h"
+#include "DrawList.h"
+#include "FrameRecorder.h"
+#include "FrameStats.h"
+#include "ImageCache.h"
+#include "ImageLoader.h"
+#include "LayerStack.h"
+#include "PixelBuffer.h"
+#include "ResizeCache.h"
+#include "RgbaColor.h"
+#include "SpriteCache.h"
+#include "TextCache.h"
+#include "TrailBuffer.h"
 
 // BETTER READABILITY
 #define GDK_IMAGE Glib::RefPtr<Gdk::Pixbuf>
 #define CAIRO_CTX_REF Cairo::RefPtr<Cairo::Context>
-#define CHRONO_HIGH_RES_CLOCK std::chrono::time_point<std::chrono::_V2::system_clock, std::chrono::nanoseconds>
+#define CHRONO_HIGH_RES_CLOCK std::chrono::steady_clock::time_point
 
 /**
- * Enumeration for Targeted Frames Per Second
+ * Enumeration for Targeted Frames Per Second. Any other rate can be given
+ *  to init_context_area as a number.
  */
 enum TARGET_FPS {
-  SIXTY, THIRTY, FIFTEEN
+  SIXTY, THIRTY, FIFTEEN, UNCAPPED
+};
+
+/**
+ * How draw_bodies draws a body, by its radius on screen.
+ *  - LOD_DISC:     Anti-aliased circle through the usual helpers
+ *  - LOD_POINT:    Single pixel write in the body's color
+ *  - LOD_DENSITY:  Counted into a density image, drawn once for all bodies
+ */
+enum BODY_LOD {
+  LOD_DISC, LOD_POINT, LOD_DENSITY
 };
 
 /**
- * Color Struct.
+ * Thresholds of draw_bodies, as radii in screen pixels. LOD_DENSITY bodies
+ *  only count towards their pixel's density, so their own colors are ignored
+ *  and every dense area is drawn in density_color.
  */
-struct RgbaColor {
-  double r;
-  double g;
-  double b;
-  double a;
+struct LodPolicy {
+  double point_radius;                                          // Below: LOD_POINT
+  double density_radius;                                        // Below: LOD_DENSITY
+  double detail_radius;                                         // Below: no Labels or Arrows
+  RgbaColor density_color;                                      // Color of Dense Areas
 };
 
 /**
  * Context struct which is a thin-wrapper that includes the cairo and ContextArea
- * metadata being passed around.
+ * metadata being passed around. With a camera, the drawing helpers take world
+ * coordinates and skip anything off screen (see world_context).
 */
 struct Context {
   const CAIRO_CTX_REF &cairo_ctx;
   const int width;
   const int height;
+  const Camera *camera;                                         // NULL for Screen Coordinates
 };
 
 /**
@@ -53,10 +87,72 @@ class ContextArea: public Gtk::DrawingArea {
     double                  fps;                                // Total Calulated Frames per Second
 
   private:        // Private Core Variables
-    CHRONO_HIGH_RES_CLOCK   prev_time;                          // Previous Time since Frame
-    int                     elapsed_frames;                     // Counter for Frames Drawn
+    CHRONO_HIGH_RES_CLOCK   prev_time;                          // Start of the Previous Frame
+    FrameStats              frame_times;                        // Start to Start of Recent Frames
+    FrameStats              draw_times;                         // Duration of Recent draw Calls
+    int64_t                 setup_time;                         // Duration of setup, Nanoseconds
     bool                    is_init;                            // Initiated Status, If init_context_area is Called
     bool                    setup_called;                       // State of setup being invoked.
+    std::atomic<bool>       offscreen;                          // Rendering through render_offscreen, Read by Decoders
+
+    // Frame Scheduling: Times in Frame Clock Microseconds
+    double                  target_fps;                         // 0 = Uncapped
+    gint64                  frame_interval;                     // Microseconds between Frames, 0 = Uncapped
+    gint64                  frame_origin;                       // Frame Clock Time of Frame 0, -1 = Unset
+    gint64                  last_frame_index;                   // Index of the Last Scheduled Frame
+    unsigned long long      missed_frames;                      // Frames whose Deadline Passed Undrawn
+    guint                   tick_callback_id;                   // 0 = Not Connected
+    bool                    on_demand;                          // Stop Ticking while Nothing Changes
+    bool                    redraw_requested;                   // A Frame was Requested since the Last
+    bool                    woke_up;                            // Next Frame Follows a Sleep, not Timed
+
+    // Draw Batching
+    DrawList                draw_list;                          // Primitives Recorded this Frame
+    bool                    batching;                           // If Helpers Record instead of Draw
+
+    // Circle Sprites
+    SpriteCache             sprite_cache;                       // Pre-Rasterized Circles
+    bool                    sprites;                            // If circle Blits Cached Sprites
+
+    // Images
+    ImageCache              image_cache;                        // Pixbufs Uploaded as Surfaces
+    ResizeCache             resize_cache;                       // Results of resize_image
+    Glib::Dispatcher        image_dispatcher;                   // Wakes the GTK Thread when Images Decode
+    ImageLoader             image_loader;                       // Decodes load_image Files in the Background
+
+    // Static Layers
+    LayerStack              layers;                             // Cached Backdrops, Composited by draw_layer
+
+    // Camera
+    Camera                  camera;                             // World to Screen for world_context
+
+    // Raw Pixels
+    PixelBuffer             pixel_buffer;                       // Framebuffer for Particle Splatting
+
+    // Level of Detail
+    LodPolicy               lod;                                // draw_bodies Thresholds
+    DensityImage            density;                            // Bins LOD_DENSITY Bodies
+
+    // Persistent Trails
+    TrailBuffer             trail_buffer;                       // Faded Accumulation Surface
+    uint64_t                trail_camera_revision;              // Camera the Trails were Stamped through
+
+    // Recording
+    FrameRecorder           recorder;                           // Encodes Captured Frames in the Background
+    Cairo::RefPtr<Cairo::ImageSurface> capture_surface;         // Windowed Frames are Drawn here while Recording
+    std::string             record_path;                        // Recording Started on the Next Frame
+    RECORD_FORMAT           record_format;
+    bool                    record_pending;
+
+    // Text
+    TextCache               text_cache;                         // Font Face, Extents and Rendered Strings
+    RgbaColor               current_color;                      // Last set_color
+    double                  current_font_size;                  // Last set_font_size
+
+    // Damage Tracking
+    bool                    damage_tracking;                    // If only Damaged Areas are Redrawn
+    bool                    full_damage;                        // If the Whole Area Needs Redrawing
+    Cairo::RefPtr<Cairo::Region> damage;                        // Reported since the Last Frame
 
     // GDK Variables
     GdkDisplay              *display;
@@ -64,9 +160,14 @@ class ContextArea: public Gtk::DrawingArea {
     GdkDevice               *device;
 
   private:        // Private Core Functions
-    void calc_frames_per_second();                              // Calculates Frames Per Second
+    void calc_frames_per_second(CHRONO_HIGH_RES_CLOCK);         // Records Frame Start, Calculates Frames Per Second
     bool on_draw(const CAIRO_CTX_REF&) override;                // Called by GTK
-    bool on_timeout();                                          // Timer for Re-Draw
+    bool on_tick(const Glib::RefPtr<Gdk::FrameClock>&);         // Frame Clock Tick, Schedules Re-Draw
+    void request_frame();                                       // Invalidates the Damage (or Everything)
+    bool take_damage(const CAIRO_CTX_REF&);                     // Clips to the Damage, False if None (Offscreen)
+    void deliver_images();                                      // Hands Decoded Images to their Handles
+    CAIRO_CTX_REF begin_capture(int width, int height);         // Context on the Capture Surface
+    void capture_frame(const Cairo::RefPtr<Cairo::ImageSurface>&, bool wait);  // Hands a Frame to the Recorder
 
   public:      // Event Functions
     virtual bool on_key_release(GdkEventKey*);                  // Key Release Event
@@ -75,13 +176,51 @@ class ContextArea: public Gtk::DrawingArea {
 
   protected:      // Helper Functions
     GDK_IMAGE create_image_buffer(std::string);                 // Easy Wrapper for Image Buffer
-    GDK_IMAGE resize_image(const GDK_IMAGE&, int, int);         // Easy Wrapper for Resizing given Image
+    IMAGE_HANDLE load_image(std::string, GDK_IMAGE placeholder = GDK_IMAGE());  // Decodes in the Background
+    GDK_IMAGE resize_image(const GDK_IMAGE&, int, int, RESAMPLE_FILTER = BILINEAR);  // Cached Resize of given Image
+    void set_resize_cache_budget(size_t bytes);                 // Max Bytes of Resized Images Kept
+    void set_image_cache_budget(size_t bytes);                  // Max Bytes of Uploaded Surfaces Kept
     void draw_image(const Context&, GDK_IMAGE);                 // Draws Given Image at (0,0)
+    void forget_image(GDK_IMAGE);                               // Re-Uploads the Image on Next Draw
+
+    // Draws given image scaled into the given rectangle.
+    void draw_image(const Context&, GDK_IMAGE, double x, double y, double width, double height);
     void background(const Context&, RgbaColor);                 // Draws background color.
 
+    // Adds a static layer drawn by the given function, which is only called again after
+    //  invalidate_layer or a resize. Returns the layer's index.
+    size_t add_layer(std::function<void(const Context&)>);
+    void draw_layer(const Context&, size_t layer);              // Composites the Layer with One Paint
+    void invalidate_layer(size_t layer);                        // Re-Draws the Layer on Next draw_layer
+
+    // Same context with helpers mapping world coordinates through the camera and culling.
+    Context world_context(const Context&);
+    Camera &get_camera();                                       // Pan and Zoom of world_context
+
+    // Draws bodies with a level of detail picked by their size on screen (see LodPolicy).
+    void draw_bodies(const Context&, const double *x, const double *y, const double *r, const RgbaColor *colors, size_t count);
+    BODY_LOD get_body_lod(const Context&, double r) const;      // Detail for a Body of World Radius r
+    bool shows_detail(const Context&, double r) const;          // If Labels and Arrows are Readable
+    void set_lod_policy(const LodPolicy&);
+    const LodPolicy &get_lod_policy() const;
+
+    // Starts drawing straight into a transparent ARGB32 framebuffer the size of the area,
+    //  composited over everything drawn before it by end_pixels.
+    PixelBuffer &begin_pixels(const Context&);
+    void end_pixels(const Context&);                            // Composites the Framebuffer with One Paint
+
+    // Fades the trail buffer once per step, stamps into it with the given function and
+    //  paints it. With 0 steps it's only painted, so redrawn frames don't stamp twice.
+    void draw_trail_buffer(const Context&, std::function<void(const Context&)> stamp, size_t steps = 1);
+    void set_trail_decay(double);                               // Fraction of Trails Kept per Step
+    void clear_trail_buffer();                                  // Erases all Trails
+
     // Draws a circle at given coordinates.
     void circle(const Context&, double x, double y, double r, const RgbaColor&);
 
+    // Draws a round-capped line between the given coordinates.
+    void line(const Context&, double x1, double y1, double x2, double y2, double width, const RgbaColor&);
+
     // Sets drawing context color.
     void set_color(const Context&, const RgbaColor&);
 
@@ -91,21 +230,55 @@ class ContextArea: public Gtk::DrawingArea {
     // Draws text at the given coordinates.
     void draw_text(const Context&, double x, double y, const char*);
 
-    // Draws information such as fps at the top right.
-    void display_nerd_info(const Context&);
+    // Extents of text in the current font size, cached while the text repeats.
+    const Cairo::TextExtents &get_text_extents(const Context&, const char*);
+
+    // Draws information such as fps and frame times at the top right, with physics step times if given.
+    void display_nerd_info(const Context&, const FrameStats::Summary *physics = NULL);
 
 
   protected:      // Shared Functions
     virtual void setup(const Context&);                         // Called ONCE prior to Draw function
     virtual void draw(const Context&);                          // Easy to use Shared Draw function
+    virtual void update();                                      // Called before each Frame is Scheduled
+    bool is_offscreen() const;                                  // If Drawing without a Window
+
+    // Makes circle, line and draw_text record into a list drawn in sorted batches after draw.
+    void enable_draw_batching(bool);
+    void flush_draw_list(const Context&);                       // Draws Recorded Primitives Now
+    void enable_circle_sprites(bool);                           // Makes circle Blit Cached Sprites
+
+    // Redraws only the areas reported through add_damage, clipping draw to them.
+    void enable_damage_tracking(bool);
+    void add_damage(double x, double y, double width, double height);  // Marks an Area for Redraw
+    void damage_all();                                          // Marks Everything for Redraw
 
 
   public:         // Public Functions
     void init_context_area();                                   // Must Be Called Prior to Running
     void init_context_area(TARGET_FPS);                         // Must Be Called Prior to Running With Given fps Target
-    const double get_fps();                                     // Returns Current fps
+    void init_context_area(double);                             // Same with any fps Target, 0 for Uncapped
+    void set_target_fps(double);                                // Changes fps Target, 0 for Uncapped
+    double get_target_fps() const;                              // Returns fps Target, 0 if Uncapped
+    unsigned long long get_missed_frames() const;               // Returns Frames that Missed their Deadline
+    void enable_on_demand(bool);                                // Only Redraws after request_redraw
+    void request_redraw();                                      // Schedules a Frame, Waking the Frame Clock
+    double get_fps();                                           // Returns Current fps
+    FrameStats::Summary get_frame_stats() const;                // Returns Recent Frame Times
+    FrameStats::Summary get_draw_stats() const;                 // Returns Recent draw Durations
+    double get_setup_time() const;                              // Returns setup Duration in ms
     void get_mouse_position(double &x, double &y);              // Simple Wrapper for Getting Mouse Position
 
+    // Records every frame to path on a background thread, format picked by extension
+    //  (.y4m, .rgba / .raw, else a PNG sequence). Offscreen frames are never dropped.
+    void start_recording(const std::string &path);
+    void start_recording(const std::string &path, RECORD_FORMAT);
+    void stop_recording();                                      // Finishes Writing Queued Frames
+    bool is_recording() const;
+
+    // Renders frames into an image surface without a window, returning each frame's draw time in ms.
+    std::vector<double> render_offscreen(int width, int height, size_t frames, const std::string &png_path = "");
+
   public:         // Constructor/Destructor
     ContextArea();
     virtual ~ContextArea();
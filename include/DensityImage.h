@@ -0,0 +1,43 @@
+#pragma once
+
+// Library Includes
+#include <cstdint>
+#include <vector>
+
+#include "PixelBuffer.h"
+
+/**
+ * Per-pixel hit counts for things too small to draw one by one. Binning is
+ *  one increment per item; resolving maps each count to a coverage through
+ *  a saturating curve and blends one color over the framebuffer, so it costs
+ *  the same for a thousand items as for a million.
+ */
+class DensityImage {
+  public:         // Public Constants
+    static constexpr double DENSITY_GAIN = 0.35;                // Coverage = 1 - e^(-gain * count)
+
+  private:        // Private Variables
+    std::vector<uint16_t>   counts;                             // Row Major, Saturating
+    int                     width, height;
+    int                     dirty_top, dirty_bottom;            // Rows with Counts, [top, bottom)
+    uint8_t                 coverage_lut[256];                  // Count to Coverage
+    std::vector<uint8_t>    coverage;                           // Scratch Row
+
+  public:         // Public Functions
+    void begin(int width, int height);                          // Sizes and Clears the Counts
+
+    // Counts one item at the given pixel, ignored outside the image.
+    inline void add(int x, int y) {
+      if ((unsigned)x >= (unsigned)width || (unsigned)y >= (unsigned)height) return;
+      uint16_t &count = counts[(size_t)y * width + x];
+      if (count < UINT16_MAX) count++;
+      if (y < dirty_top) dirty_top = y;
+      if (y >= dirty_bottom) dirty_bottom = y + 1;
+    }
+
+    // Blends the color over the framebuffer, scaled by each pixel's density.
+    void resolve(PixelBuffer&, const RgbaColor&);
+
+  public:         // Constructor
+    DensityImage();
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "RgbaColor.h"
+#include "SpriteCache.h"
+#include "TextCache.h"
+
+/**
+ * Retained list of draw commands for one frame. Primitives are recorded with
+ *  the color, line width and font size current at the time, then on flush()
+ *  sorted by kind and state and merged: every run of same-colored circles is
+ *  one fill, every run of lines with the same color and width one stroke.
+ *
+ * Flushed commands are drawn fills first, then strokes, then text, so only
+ *  the layering between different states is lost. Overlapping translucent
+ *  shapes of one run are filled as their union rather than blended twice.
+ *
+ * Coordinates are recorded as given, not transformed: flush() draws them
+ *  with the context's transform and clip at flush time. Record with the
+ *  same transform and clip that will be active at flush (normally identity
+ *  and no clip), or flush before changing either.
+ */
+class DrawList {
+  public:         // Public Types
+    enum COMMAND_TYPE {
+      FILL_CIRCLE, STROKE_LINE, SHOW_TEXT
+    };
+
+  private:        // Private Types
+    struct DrawState {
+      RgbaColor   color;
+      double      line_width;
+      double      font_size;
+    };
+
+    struct Command {
+      COMMAND_TYPE  type;
+      uint32_t      state;                                      // Index into states
+      uint32_t      order;                                      // Record Order, Keeps the Sort Stable
+      uint32_t      text;                                       // Offset into text_data
+      double        a, b, c, d;                                 // Circle: x, y, r | Line: x1, y1, x2, y2 | Text: x, y
+    };
+
+  private:        // Private Variables
+    std::vector<DrawState>  states;                             // States used by Commands this Frame
+    std::vector<Command>    commands;
+    std::string             text_data;                          // Null-Terminated Strings, Back to Back
+    DrawState               current;                            // State for the Next Command
+    bool                    state_changed;                      // current not yet in states
+
+  private:        // Private Functions
+    uint32_t current_state();                                   // Index of current in states
+    bool same_batch(const Command&, const Command&) const;      // If two Commands Merge into one Draw
+    bool state_less(uint32_t, uint32_t) const;                  // Orders States by Value
+
+  public:         // Public Functions
+    void set_color(const RgbaColor&);
+    void set_line_width(double);
+    void set_font_size(double);
+
+    void circle(double x, double y, double r);                  // Records a Filled Circle
+    void line(double x1, double y1, double x2, double y2);      // Records a Round-Capped Line
+    void text(double x, double y, const char*);                 // Records Text, Copied
+
+    // Draws and Clears every Command, through the sprite and text caches if given.
+    void flush(const Cairo::RefPtr<Cairo::Context>&, SpriteCache *sprites = NULL, TextCache *text = NULL);
+    void clear();                                               // Drops every Command
+    size_t size() const;                                        // Commands Recorded
+
+  public:         // Constructor
+    DrawList();
+};
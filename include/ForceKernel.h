@@ -0,0 +1,31 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+
+/**
+ * Enumeration for Instruction Sets the Direct Sum Kernel can use,
+ *  ordered from slowest to fastest.
+ */
+enum SIMD_LEVEL {
+  SCALAR, SSE2, AVX2, AVX512
+};
+
+/**
+ * Direct Sum Kernel
+ *  Calculates the net gravitational force on bodies [begin, end) from all
+ *  n bodies and stores it into fx/fy. Coincident bodies (including self)
+ *  exert no force.
+ *
+ * The vectorized kernels use the same full precision sqrt + divide per pair
+ *  as the scalar kernel, and no trigonometry, so they only differ from it
+ *  in summation order.
+ */
+typedef void (*DirectSumKernel)(
+  const double *x, const double *y, const double *mass, size_t n,
+  size_t begin, size_t end, double *fx, double *fy
+);
+
+SIMD_LEVEL detect_simd_level();                                 // Best Level Supported by the Running CPU
+const char *simd_level_name(SIMD_LEVEL);                        // Human-Readable Level Name
+DirectSumKernel get_direct_sum_kernel(SIMD_LEVEL);              // Kernel for Given Level
@@ -0,0 +1,87 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Output formats of the FrameRecorder.
+ *  - Y4M:          One YUV4MPEG2 file, 4:4:4 BT.601, readable by ffmpeg
+ *  - RAW_RGBA:     One file of straight-alpha RGBA8 frames, back to back
+ *  - PNG_SEQUENCE: One PNG per frame, named <path>_000000.png and on
+ */
+enum RECORD_FORMAT {
+  Y4M, RAW_RGBA, PNG_SEQUENCE
+};
+
+/**
+ * Records rendered frames to disk on a background thread. capture() copies
+ *  a frame into one of a fixed pool of buffers allocated by start(), so the
+ *  render thread never allocates or touches the disk. The encoder thread
+ *  converts and writes queued frames, then hands their buffers back.
+ *
+ * Frames are written at the size recording started with, cropped or padded
+ *  with transparent black if the source size changes.
+ */
+class FrameRecorder {
+  private:        // Private Types
+    struct FrameBuffer {
+      std::vector<uint32_t>   pixels;                           // Premultiplied ARGB32, Tightly Packed
+      uint64_t                index;                            // Frame Number
+    };
+
+  private:        // Private Variables
+    RECORD_FORMAT               format;
+    std::string                 path;
+    int                         width, height;
+    double                      fps;
+    FILE                        *out;                           // Y4M and RAW_RGBA Output
+    bool                        recording;
+
+    std::vector<FrameBuffer>    buffers;                        // The Pool
+    std::vector<FrameBuffer*>   free_buffers;                   // Ready for capture
+    std::deque<FrameBuffer*>    queued;                         // Waiting for the Encoder
+    bool                        stopping;
+    std::mutex                  mutex;
+    std::condition_variable     frame_queued;                   // Wakes the Encoder
+    std::condition_variable     buffer_freed;                   // Wakes a Waiting capture
+    std::thread                 encoder;
+
+    std::vector<uint8_t>        scratch;                        // Encoder's Converted Frame
+    uint64_t                    next_index;                     // Render Thread
+    std::atomic<uint64_t>       written_frames;
+    std::atomic<uint64_t>       dropped_frames;
+    std::atomic<bool>           write_failed;
+
+  private:        // Private Functions
+    void encoder_loop();                                        // Encoder Thread Entry
+    bool write_frame(const FrameBuffer&);                       // Converts and Writes One Frame
+
+  public:         // Public Functions
+    // Opens the output and allocates buffer_count frame buffers. False if the output can't be opened.
+    bool start(const std::string &path, RECORD_FORMAT, int width, int height, double fps, size_t buffer_count = 8);
+    void stop();                                                // Writes Queued Frames, Closes the Output
+
+    // Copies a frame into a free buffer and queues it. If none is free, waits for one
+    //  when wait is set, otherwise drops the frame and returns False.
+    bool capture(const uint8_t *argb32, int width, int height, int stride, bool wait);
+
+    bool is_recording() const;
+    uint64_t get_written_frames() const;
+    uint64_t get_dropped_frames() const;                        // Frames with no Free Buffer
+
+  public:         // Static Functions
+    static RECORD_FORMAT format_for_path(const std::string&);   // .y4m, .rgba / .raw or else PNG
+
+  public:         // Constructor/Destructor
+    FrameRecorder();
+    ~FrameRecorder();
+};
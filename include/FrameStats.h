@@ -0,0 +1,43 @@
+#pragma once
+
+// Library Includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Rolling record of the last WINDOW durations, in nanoseconds, kept in a
+ *  fixed ring so recording never allocates. The mean is kept up to date on
+ *  every record; percentiles are computed on request.
+ */
+class FrameStats {
+  public:         // Public Types
+    static const size_t WINDOW = 240;                           // Samples Kept, ~4s at 60fps
+
+    struct Summary {
+      size_t    samples;                                        // 0 if Nothing Recorded
+      double    min_ms;
+      double    mean_ms;
+      double    p50_ms;
+      double    p95_ms;
+      double    p99_ms;
+      double    max_ms;
+    };
+
+  private:        // Private Variables
+    std::array<int64_t, WINDOW>             samples;            // Ring of Durations
+    mutable std::array<int64_t, WINDOW>     sorted;             // Scratch for Percentiles
+    size_t                                  head;               // Next Slot to Write
+    size_t                                  count;              // Samples Held
+    int64_t                                 total;              // Sum of Held Samples
+
+  public:         // Public Functions
+    void record(int64_t ns);                                    // Adds a Duration, Dropping the Oldest
+    void clear();                                               // Removes all Samples
+    Summary summary() const;                                    // min/mean/p50/p95/p99/max of the Window
+    double mean_ms() const;                                     // Mean of the Window, O(1)
+    size_t size() const;                                        // Samples Held
+
+  public:         // Constructor
+    FrameStats();
+};
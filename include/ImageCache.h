@@ -0,0 +1,60 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <list>
+#include <unordered_map>
+
+#include "PixelKernel.h"
+
+/**
+ * Cache of pixbufs uploaded to Cairo image surfaces. Each pixbuf is converted
+ *  to premultiplied ARGB32 once, with the fastest premultiply kernel the CPU
+ *  supports, and its surface reused for every draw after that.
+ *
+ * Surfaces are kept up to a byte budget, evicting the least recently drawn
+ *  ones past it, so pixbufs that are no longer drawn don't stay pinned.
+ *
+ * Pixbufs are treated as immutable: after changing a pixbuf's pixels, call
+ *  forget() so the next draw uploads it again.
+ */
+class ImageCache {
+  public:         // Public Types
+    static const size_t DEFAULT_BUDGET = 128 * 1024 * 1024;     // Bytes of Surfaces
+
+  private:        // Private Types
+    struct Entry {
+      Glib::RefPtr<Gdk::Pixbuf>           pixbuf;               // Held so the Key Stays Valid
+      Cairo::RefPtr<Cairo::ImageSurface>  surface;
+      size_t                              bytes;
+    };
+
+  private:        // Private Variables
+    std::list<Entry>                                                        lru;        // Most Recently Drawn First
+    std::unordered_map<const Gdk::Pixbuf*, std::list<Entry>::iterator>     entries;
+    size_t                                                                  budget;
+    size_t                                                                  used;       // Bytes Held
+    PremultiplyKernel                                                       premultiply;
+
+  private:        // Private Functions
+    void evict_to(size_t bytes);                                // Drops LRU Entries down to bytes
+
+  public:         // Public Functions
+    // Surface of the pixbuf, uploading it on first use. Empty for pixbufs that aren't 8-bit.
+    Cairo::RefPtr<Cairo::ImageSurface> get_surface(const Glib::RefPtr<Gdk::Pixbuf>&);
+
+    void forget(const Glib::RefPtr<Gdk::Pixbuf>&);              // Drops One Pixbuf's Surface
+    void clear();                                               // Drops every Surface
+    void set_budget(size_t bytes);                              // Evicts down to the new Budget
+
+    size_t get_budget() const;
+    size_t get_used_bytes() const;
+    size_t size() const;                                        // Pixbufs Cached
+
+  public:         // Static Functions
+    // Converts a pixbuf into a new ARGB32 surface.
+    static Cairo::RefPtr<Cairo::ImageSurface> upload(const Glib::RefPtr<Gdk::Pixbuf>&, PremultiplyKernel);
+
+  public:         // Constructor
+    ImageCache(size_t budget = DEFAULT_BUDGET);
+};
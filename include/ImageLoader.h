@@ -0,0 +1,98 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Status of an asynchronously loaded image.
+ */
+enum IMAGE_STATUS {
+  IMAGE_PENDING, IMAGE_READY, IMAGE_FAILED
+};
+
+/**
+ * Image being decoded in the background. Its fields only change during
+ *  ImageLoader::poll, so the GTK thread can read them without locking.
+ */
+class ImageRequest {
+  friend class ImageLoader;
+
+  private:        // Private Variables
+    std::string                 path;
+    IMAGE_STATUS                status;
+    Glib::RefPtr<Gdk::Pixbuf>   image;                          // Decoded Image, once Ready
+    Glib::RefPtr<Gdk::Pixbuf>   placeholder;                    // Shown until Ready
+    std::string                 error;                          // Why Decoding Failed
+
+  public:         // Public Functions
+    // Decoded image once ready, the placeholder (possibly empty) until then.
+    Glib::RefPtr<Gdk::Pixbuf> get() const;
+
+    IMAGE_STATUS get_status() const;
+    bool is_ready() const;
+    const std::string &get_path() const;
+    const std::string &get_error() const;                       // Empty unless Failed
+
+  public:         // Constructor
+    ImageRequest(const std::string &path, const Glib::RefPtr<Gdk::Pixbuf> &placeholder);
+};
+
+typedef std::shared_ptr<ImageRequest> IMAGE_HANDLE;
+
+/**
+ * Decodes image files on background worker threads. load() returns a
+ *  handle right away; decoded images are handed back to the GTK thread by
+ *  poll(), which never waits on the workers.
+ */
+class ImageLoader {
+  public:         // Public Types
+    typedef std::function<void()> NotifyFn;
+
+  private:        // Private Types
+    struct Decoded {
+      IMAGE_HANDLE                request;
+      Glib::RefPtr<Gdk::Pixbuf>   image;                        // Empty if Decoding Failed
+      std::string                 error;
+    };
+
+  private:        // Private Variables
+    std::vector<std::thread>    workers;                        // Started on First load
+    size_t                      thread_count;
+    bool                        stopping;
+
+    std::mutex                  queue_mutex;
+    std::condition_variable     wake;                           // Signals Workers of new Paths
+    std::deque<IMAGE_HANDLE>    queue;                          // Waiting to be Decoded
+
+    std::mutex                  decoded_mutex;
+    std::vector<Decoded>        decoded;                        // Waiting for poll
+    std::vector<Decoded>        delivering;                     // Being Delivered by poll
+    size_t                      in_flight;                      // Loaded, not yet Delivered (GTK Thread)
+
+    NotifyFn                    on_decoded;                     // Called on a Worker after each Decode
+
+  private:        // Private Functions
+    void worker_loop();                                         // Worker Thread Entry
+
+  public:         // Public Functions
+    // Queues a file for decoding, drawing the placeholder until it's done.
+    IMAGE_HANDLE load(const std::string &path, const Glib::RefPtr<Gdk::Pixbuf> &placeholder = Glib::RefPtr<Gdk::Pixbuf>());
+
+    size_t poll();                                              // Delivers Decoded Images, Returns Count
+    size_t pending() const;                                     // Images not yet Delivered
+
+    // Called from a worker thread after each decode, e.g. to wake the GTK thread.
+    void set_on_decoded(NotifyFn);
+
+  public:         // Constructor/Destructor
+    ImageLoader(size_t thread_count = 2);
+    ~ImageLoader();
+};
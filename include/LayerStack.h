@@ -0,0 +1,40 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <functional>
+#include <vector>
+
+/**
+ * Static layers kept rasterized in their own backing surfaces. A layer is
+ *  painted once into a surface similar to the target it's composited onto,
+ *  then composited with a single paint per frame until it's invalidated or
+ *  the target size changes.
+ */
+class LayerStack {
+  public:         // Public Types
+    // Paints a layer's content onto a fresh, transparent context of the given size.
+    typedef std::function<void(const Cairo::RefPtr<Cairo::Context>&, int width, int height)> PaintFn;
+
+  private:        // Private Types
+    struct Layer {
+      PaintFn                         paint;
+      Cairo::RefPtr<Cairo::Surface>   surface;                  // Empty until First Composite
+      int                             width, height;            // Size the Surface was Painted at
+      bool                            valid;                    // If the Surface is Up to Date
+    };
+
+  private:        // Private Variables
+    std::vector<Layer>  layers;
+
+  public:         // Public Functions
+    size_t add(PaintFn);                                        // Adds a Layer, Returns its Index
+    void invalidate(size_t layer);                              // Re-Paints the Layer on Next Composite
+    void invalidate_all();                                      // Same for every Layer
+
+    // Paints the layer onto the context, re-rasterizing it first if needed.
+    void composite(const Cairo::RefPtr<Cairo::Context>&, size_t layer, int width, int height);
+
+    bool is_valid(size_t layer) const;
+    size_t size() const;                                        // Number of Layers
+};
@@ -42,4 +42,6 @@ class MyWindow : public Gtk::Window {
     bool on_key_press_event(GdkEventKey *event);                    // Key Press Event
     bool on_key_release_event(GdkEventKey *event);                  // Key Release Event
     bool on_button_press_event(GdkEventButton *event);              // Button Press Event
+    bool on_motion_notify_event(GdkEventMotion *event);             // Pointer Motion Event
+    bool on_scroll_event(GdkEventScroll *event);                    // Scroll Event
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+// Library Includes
+#include <cmath>
+
+const double GRAVITATIONAL_CONST = 1.f;
+
+/**
+ * Simple 2D Vector.
+ */
+struct Vector2D {
+  double x;
+  double y;
+};
+
+/**
+ * Enumeration for the Gravity Solver used by the Physics Step
+ *  - DIRECT_SUM: Exact O(n²) pairwise summation
+ *  - BARNES_HUT: O(n log n) QuadTree approximation, see QuadTree.h
+ */
+enum FORCE_MODE {
+  DIRECT_SUM, BARNES_HUT
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+// Library Includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FrameStats.h"
+#include "Simulation.h"
+#include "TripleBuffer.h"
+
+/**
+ * Runs a Simulation on its own thread at a fixed tick rate, independent of
+ *  the frame rate. Every completed step is published as a SimulationSnapshot
+ *  through a lock-free triple buffer, so drawing never waits on physics and
+ *  a slow frame never slows the simulation down.
+ *
+ * Once started, the Simulation must only be touched from the physics thread,
+ *  through post().
+ */
+class PhysicsThread {
+  public:         // Public Types
+    typedef std::function<void(Simulation&)> Command;
+
+    static const unsigned int   MAX_LAG_TICKS = 5;              // Ticks Behind before Dropping
+
+  private:        // Private Variables
+    Simulation                          &simulation;
+    std::chrono::nanoseconds            tick_interval;
+    std::thread                         thread;
+    std::atomic<bool>                   running;
+    std::atomic<uint64_t>               dropped_ticks;          // Ticks Skipped when Overloaded
+
+    TripleBuffer<SimulationSnapshot>    snapshots;
+
+    std::mutex                          command_mutex;
+    std::vector<Command>                commands;               // Posted, not yet Applied
+    std::vector<Command>                pending;                // Being Applied
+
+    mutable std::mutex                  stats_mutex;
+    FrameStats                          step_times;             // Duration of each Step
+
+  private:        // Private Functions
+    void apply_commands();                                      // Runs Posted Commands
+    void run();                                                 // Physics Thread Entry
+
+  public:         // Public Functions
+    void start();                                               // Publishes State, Starts Ticking
+    void stop();                                                // Stops and Joins the Thread
+
+    void post(Command);                                         // Runs Command before the Next Tick
+    void tick();                                                // One Step on the Caller, only while Stopped
+
+    // Newest published state. Only call from a single (drawing) thread.
+    const SimulationSnapshot &latest_snapshot();
+
+    double get_tick_rate() const;                               // Ticks per Second
+    uint64_t get_dropped_ticks() const;
+    FrameStats::Summary get_step_stats() const;                 // Recent Step Durations
+
+  public:         // Constructor/Destructor
+    PhysicsThread(Simulation &simulation, double tick_rate = 60.0);
+    ~PhysicsThread();
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <cstdint>
+#include <vector>
+
+#include "PixelKernel.h"
+#include "RgbaColor.h"
+
+/**
+ * Raw premultiplied ARGB32 framebuffer backed by a Cairo image surface, for
+ *  particle-style scenes where per-primitive Cairo calls dominate. Points,
+ *  discs and rectangles are written straight into the pixels with SIMD span
+ *  blending, then the whole buffer is composited with one paint.
+ *
+ * Only rows touched since the last begin() are cleared by the next one, so
+ *  sparse scenes don't pay for clearing the whole frame.
+ */
+class PixelBuffer {
+  private:        // Private Variables
+    Cairo::RefPtr<Cairo::ImageSurface>  surface;                // Empty until First begin
+    uint32_t                *pixels;
+    int                     width, height;
+    size_t                  stride;                             // Pixels per Row
+    int                     dirty_top, dirty_bottom;            // Rows Written since Clearing, [top, bottom)
+
+    std::vector<uint8_t>    coverage;                           // Scratch Span Coverage
+    BlendSpanKernel         blend_over, blend_add;
+
+  private:        // Private Functions
+    BlendSpanKernel get_blend(BLEND_MODE) const;
+    void touch_rows(int top, int bottom);                       // Marks Rows to Clear Next Frame
+    void disc_span(int y, double x, double dy, double r, uint32_t color, BlendSpanKernel);
+
+  public:         // Public Functions
+    void begin(int width, int height);                          // Sizes the Buffer, Clears it to Transparent
+    void composite(const Cairo::RefPtr<Cairo::Context>&);       // Paints the Buffer with One Paint
+
+    void clear(const RgbaColor&);                               // Sets every Pixel, no Blending
+    void fill_rect(int x, int y, int width, int height, const RgbaColor&, BLEND_MODE = BLEND_OVER);
+    void point(double x, double y, const RgbaColor&, BLEND_MODE = BLEND_OVER);
+    void points(const double *x, const double *y, size_t count, const RgbaColor&, BLEND_MODE = BLEND_OVER);
+    void disc(double x, double y, double r, const RgbaColor&, BLEND_MODE = BLEND_OVER);
+    void discs(const double *x, const double *y, const double *r, size_t count, const RgbaColor&, BLEND_MODE = BLEND_OVER);
+
+    // Blends a color over count pixels of row y from x on, scaled by per-pixel coverage.
+    void span(int y, int x, const uint8_t *coverage, int count, const RgbaColor&, BLEND_MODE = BLEND_OVER);
+
+    // Raw Access: Report rows written directly with mark_rows, so they're cleared.
+    uint32_t *get_row(int y);
+    void mark_rows(int top, int bottom);
+    int get_width() const;
+    int get_height() const;
+
+  public:         // Static Functions
+    static uint32_t to_argb32(const RgbaColor&);                // Premultiplied Pixel of a Color
+
+  public:         // Constructor
+    PixelBuffer();
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <cstdint>
+
+#include "ForceKernel.h"
+
+/**
+ * Premultiply Kernel
+ *  Converts count straight-alpha RGBA8 pixels (GdkPixbuf layout) into
+ *  premultiplied native-endian ARGB32 pixels (Cairo layout). Each color
+ *  channel becomes round(c * a / 255), exactly as GDK computes it, so every
+ *  kernel gives identical output.
+ */
+typedef void (*PremultiplyKernel)(const uint8_t *src, uint32_t *dst, size_t count);
+
+PremultiplyKernel get_premultiply_kernel(SIMD_LEVEL);           // Kernel for Given Level
+void rgb_to_argb32(const uint8_t *src, uint32_t *dst, size_t count);  // Opaque RGB8 Pixels to ARGB32
+
+/**
+ * Fade Kernel
+ *  Scales every channel of count premultiplied ARGB32 pixels by factor / 256,
+ *  rounding down, so repeated fades always reach zero. Scaling alpha and color
+ *  alike keeps pixels validly premultiplied. factor is in [0, 256].
+ */
+typedef void (*FadeKernel)(uint32_t *pixels, size_t count, uint32_t factor);
+
+FadeKernel get_fade_kernel(SIMD_LEVEL);                         // Kernel for Given Level
+
+/**
+ * How splatted pixels combine with the framebuffer.
+ *  - BLEND_OVER: Porter-Duff over, like Cairo's default operator
+ *  - BLEND_ADD:  Saturating add, so overlapping particles glow
+ */
+enum BLEND_MODE {
+  BLEND_OVER, BLEND_ADD
+};
+
+/**
+ * Blend Span Kernel
+ *  Blends one premultiplied ARGB32 color onto count consecutive pixels,
+ *  scaled by each pixel's 8-bit coverage (255 = fully covered).
+ */
+typedef void (*BlendSpanKernel)(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color);
+
+BlendSpanKernel get_blend_span_kernel(SIMD_LEVEL, BLEND_MODE);  // Kernel for Given Level and Mode
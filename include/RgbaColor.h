@@ -0,0 +1,32 @@
+#pragma once
+
+// Library Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Color Struct.
+ */
+struct RgbaColor {
+  double r;
+  double g;
+  double b;
+  double a;
+};
+
+/**
+ * @param channel - Color channel in [0, 1], clamped
+ * @return Channel quantized to 8 bits
+ */
+inline uint32_t channel_8(double channel) {
+  return (uint32_t)std::lround(std::min(std::max(channel, 0.0), 1.0) * 255.0);
+}
+
+/**
+ * @param color - Color to pack
+ * @return Straight-alpha RGBA8, red in the top byte, e.g. for cache keys
+ */
+inline uint32_t to_rgba8(const RgbaColor &color) {
+  return channel_8(color.r) << 24 | channel_8(color.g) << 16 | channel_8(color.b) << 8 | channel_8(color.a);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BodyStore.h"
+#include "ForceKernel.h"
+#include "QuadTree.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+#include "TrailPool.h"
+
+/**
+ * Copy of a Simulation's state after a step, for drawing. See Simulation::snapshot.
+ */
+struct SimulationSnapshot {
+  BodyStore                           bodies;
+  std::vector<double>                 force_x, force_y;         // Net Force of the Step
+  TrailPool                           trails;                   // Caught up Incrementally
+  uint64_t                            step_count = 0;           // Steps Taken so far
+};
+
+/**
+ * N-Body Gravity Simulation, independent of any drawing.
+ *
+ * Each step computes forces and collisions from the state at the start of
+ *  the step only, then integrates every body, so results do not depend on the
+ *  order bodies are visited in. Both phases are split across a thread pool
+ *  and give the same results for any thread count.
+ */
+class Simulation {
+  public:         // Tuning Constants
+    static const size_t     SOLVE_GRAIN = 16;                   // Min Bodies per Solve Chunk
+    static const size_t     INTEGRATE_GRAIN = 4096;             // Min Bodies per Integrate Chunk
+
+  private:        // Body State
+    BodyStore                           bodies;                 // SoA Body Attributes
+    TrailPool                           trails;                 // Past Positions per Body
+    uint64_t                            step_count;
+
+  private:        // Solver State
+    FORCE_MODE              force_mode;                         // Gravity Solver used by step
+    double                  theta;                              // Barnes-Hut Opening Angle
+    QuadTree                quad_tree;
+    SpatialGrid             collision_grid;                     // Collision Broad Phase
+    SIMD_LEVEL              simd_level;                         // Instruction Set of the Direct Sum
+    DirectSumKernel         direct_sum_kernel;
+
+    // Per-step scratch buffers, reused between steps.
+    std::vector<double>     next_x, next_y, next_vx, next_vy;
+    std::vector<double>     force_x, force_y;                   // Net Force of the Last Step
+    std::vector<std::vector<size_t>>    worker_contacts;        // Contacts Scratch per Worker
+    std::unique_ptr<ThreadPool>         thread_pool;
+
+  private:        // Private Functions
+    void direct_sum_forces(double *fx, double *fy) const;       // Exact Net Force on every Body
+    void build_quad_tree();                                     // Rebuilds Tree over Current State
+    void record_trail(size_t i);                                // Pushes Current Position to Trail
+
+    // Step phases over bodies [begin, end).
+    void solve_bodies(size_t begin, size_t end, std::vector<size_t> &contacts);
+    void integrate_bodies(size_t begin, size_t end);
+
+  public:         // Public Functions
+    // Adds a body, returning its index.
+    size_t add_body(Vector2D pos, double mass, double radius, Vector2D velocity, Vector2D acceleration);
+
+    void step();                                                // Advances the Simulation One Step
+    void snapshot(SimulationSnapshot &) const;                  // Copies State for Drawing
+
+    // Compares the Barnes-Hut forces against the direct sum for the current state.
+    void measure_force_error(double &rms_error, double &max_error);
+
+  public:         // Getters / Setters
+    BodyStore &get_bodies();
+    const BodyStore &get_bodies() const;
+    const TrailPool &get_trails() const;
+    Vector2D get_net_force(size_t i) const;                     // Net Force on Body i from Last Step
+    uint64_t get_step_count() const;
+
+    FORCE_MODE get_force_mode() const;
+    void set_force_mode(FORCE_MODE);
+    double get_theta() const;
+    void set_theta(double);
+    SIMD_LEVEL get_simd_level() const;
+    void set_simd_level(SIMD_LEVEL);
+    size_t get_thread_count() const;
+    void set_thread_count(size_t);                              // 0 = Hardware Concurrency
+
+  public:         // Constructor
+    Simulation(size_t max_trail_size = 32);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Uniform Spatial Hash Grid used as the collision broad phase.
+ *
+ * Cells are as wide as the largest body diameter, so two overlapping bodies
+ *  are always in the same or neighbouring cells. Cells are hashed into a
+ *  table about twice the body count and bodies are counting-sorted into it,
+ *  so a rebuild is O(n) and a query only visits the 3x3 cells around a body.
+ *
+ * Bodies are referenced by index into the arrays passed to build(), which
+ *  must stay valid until the next build().
+ */
+class SpatialGrid {
+  private:        // Private Variables
+    double                  cell_size;
+    double                  inv_cell_size;
+    size_t                  bucket_mask;                        // Table Size - 1 (Power of 2)
+
+    std::vector<uint32_t>   bucket_start;                       // Start of each Bucket in 'sorted'
+    std::vector<uint32_t>   sorted;                             // Body Indices sorted by Bucket
+    std::vector<uint32_t>   body_bucket;                        // Bucket of each Body
+
+    const double            *x, *y, *radius;                    // Borrowed Body Arrays
+
+  private:        // Private Functions
+    int64_t cell_coord(double) const;                           // World Coordinate to Cell Coordinate
+    size_t bucket_of(int64_t cx, int64_t cy) const;             // Hashes a Cell into the Table
+
+  public:         // Public Functions
+    // Rebuilds the grid over the given body arrays.
+    void build(const double *x, const double *y, const double *radius, size_t count);
+
+    // Appends every body overlapping body i to contacts, in no particular order.
+    void find_contacts(size_t i, std::vector<size_t> &contacts) const;
+
+    double get_cell_size() const;
+
+  public:         // Constructor
+    SpatialGrid();
+};
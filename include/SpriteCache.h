@@ -0,0 +1,49 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "RgbaColor.h"
+
+/**
+ * Cache of pre-rasterized, anti-aliased circles. Each radius (quantized to
+ *  RADIUS_STEP), color and device scale is drawn once into a small ARGB32
+ *  surface at the target's full resolution, after which drawing that circle
+ *  is a single pixel-aligned blit instead of an arc tessellation and fill.
+ *  Past MAX_SPRITES the least recently drawn sprite is dropped.
+ *
+ * Sprites are placed on whole device pixels, so centers may move by up to
+ *  half a pixel. Circles that are too large, or drawn through a rotating or
+ *  scaling transform, are left to the caller.
+ */
+class SpriteCache {
+  public:         // Public Constants
+    static constexpr double RADIUS_STEP = 0.25;                 // Radius Quantization in Pixels
+    static constexpr double MAX_RADIUS  = 64.0;                 // Larger Circles are not Cached
+    static const size_t     MAX_SPRITES = 4096;                 // LRU Sprites Evicted Past this
+
+  private:        // Private Types
+    struct Sprite {
+      Cairo::RefPtr<Cairo::ImageSurface>  surface;              // Carries the Device Scale it was Drawn for
+      double                              center;               // Circle Center within the Surface
+      double                              size;                 // Surface Size in User Units
+      std::list<uint64_t>::iterator       lru_slot;
+    };
+
+  private:        // Private Variables
+    std::unordered_map<uint64_t, Sprite>  sprites;              // By Device Scale + Quantized Radius + RGBA8 Color
+    std::list<uint64_t>                   lru;                  // Keys, Most Recently Drawn First
+
+  private:        // Private Functions
+    const Sprite &get_sprite(uint32_t radius_steps, const RgbaColor&, double scale);
+
+  public:         // Public Functions
+    // Draws a filled circle from its sprite. Returns False, drawing nothing, if it can't be a sprite.
+    bool draw_circle(const Cairo::RefPtr<Cairo::Context>&, double x, double y, double r, const RgbaColor&);
+
+    void clear();                                               // Drops every Sprite
+    size_t size() const;                                        // Sprites Cached
+};
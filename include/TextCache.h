@@ -0,0 +1,72 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "RgbaColor.h"
+
+/**
+ * Text drawing with the "Sans" font face resolved once. Extents are cached
+ *  per string, font size and color, and strings drawn on consecutive frames
+ *  are rendered once into a surface that later frames blit, so the same
+ *  string in two colors keeps two surfaces. Surfaces are rendered at the
+ *  target's device scale, so HiDPI text stays sharp. Strings that change every frame
+ *  are drawn straight with show_text and forgotten after a couple of frames,
+ *  so they never pay for a surface.
+ *
+ * end_frame() must be called once per frame to age out unused strings. It
+ *  only looks at the oldest strings, kept in order of last use.
+ */
+class TextCache {
+  public:         // Public Constants
+    static const uint64_t   ONE_OFF_FRAMES  = 2;                // Frames a String Seen Once is Kept
+    static const uint64_t   STALE_FRAMES    = 120;              // Frames a Repeating String is Kept
+
+  private:        // Private Types
+    typedef std::list<const std::string*> AgeList;              // Keys, Most Recently Used First
+
+    struct Entry {
+      Cairo::TextExtents                  extents;
+      Cairo::RefPtr<Cairo::ImageSurface>  surface;              // Rendered Text, Empty until it Repeats
+      double                              origin_x, origin_y;   // Text Origin within the Surface
+      double                              width, height;        // Surface Size in User Units
+      uint32_t                            uses;                 // Consecutive Frames Drawn
+      uint64_t                            last_frame;           // Frame Last Drawn or Measured
+      bool                                repeating;            // In repeating, Else one_off
+      AgeList::iterator                   age_slot;
+    };
+
+  private:        // Private Variables
+    Cairo::RefPtr<Cairo::ToyFontFace>       font_face;
+    std::unordered_map<std::string, Entry>  entries;            // By Text + Font Size + RGBA8 Color + Device Scale
+    AgeList                                 one_off;            // Strings not Drawn on Consecutive Frames
+    AgeList                                 repeating;          // Strings Drawn on Consecutive Frames
+    std::string                             key;                // Reused Lookup Key
+    uint64_t                                frame;
+
+  private:        // Private Functions
+    Entry &get_entry(const Cairo::RefPtr<Cairo::Context>&, const char*, double font_size, uint32_t rgba, double scale);
+    void touch(Entry&);                                         // Moves to the Front of its Age List
+    void expire(AgeList&, uint64_t keep);                       // Drops Entries Unused for keep Frames
+    void render_surface(Entry&, const char*, double font_size, const RgbaColor&, double scale);
+
+  public:         // Public Functions
+    void set_font(const Cairo::RefPtr<Cairo::Context>&, double font_size);  // Selects the Cached Face
+
+    // Extents of the text at the given font size.
+    const Cairo::TextExtents &get_extents(const Cairo::RefPtr<Cairo::Context>&, const char*, double font_size);
+
+    // Draws text with its origin at (x, y).
+    void draw_text(const Cairo::RefPtr<Cairo::Context>&, double x, double y, const char*, double font_size, const RgbaColor&);
+
+    void end_frame();                                           // Drops Strings no Longer Drawn
+    void clear();                                               // Drops every String
+    size_t size() const;                                        // Strings Cached
+
+  public:         // Constructor
+    TextCache();
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+// Library Includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-Stealing Thread Pool for data-parallel loops.
+ *
+ * parallel_for splits a range into chunks spread evenly over per-thread
+ *  queues. Each thread drains its own queue front to back, then steals from
+ *  the back of the others, so uneven chunks still balance out. The calling
+ *  thread takes part as worker 0 and returns once every chunk is done.
+ */
+class ThreadPool {
+  public:         // Public Types
+    // Loop body: processes [begin, end) on the given worker (0 to thread count - 1).
+    typedef std::function<void(size_t begin, size_t end, size_t worker)> RangeFn;
+
+  private:        // Private Structures
+    struct Range {
+      size_t begin, end;
+    };
+
+    struct WorkerQueue {
+      std::mutex          mutex;
+      std::deque<Range>   ranges;
+    };
+
+  private:        // Private Variables
+    std::vector<std::thread>                    workers;        // Worker Threads (1 to N-1)
+    std::vector<std::unique_ptr<WorkerQueue>>   queues;         // One Queue per Thread, Caller at 0
+
+    const RangeFn           *job;                               // Loop Body of the Current parallel_for
+    std::atomic<size_t>     remaining;                          // Chunks not yet Finished
+    uint64_t                generation;                         // Bumped on every parallel_for
+    bool                    stopping;
+
+    std::mutex              mutex;
+    std::condition_variable wake;                               // Signals Workers of new Work
+    std::condition_variable done;                               // Signals Caller of Completion
+
+  private:        // Private Functions
+    bool pop_range(size_t worker, Range &range);                // Own Queue first, then Steal
+    void run_ranges(size_t worker);                             // Runs Chunks until none are Left
+    void worker_loop(size_t worker);                            // Worker Thread Entry
+
+  public:         // Public Functions
+    // Runs fn over [0, count) in chunks of at least grain items.
+    void parallel_for(size_t count, size_t grain, const RangeFn &fn);
+
+    size_t get_thread_count() const;                            // Threads incl. the Caller
+
+  public:         // Constructor/Destructor
+    ThreadPool(size_t thread_count = 0);                        // 0 = Hardware Concurrency
+    ~ThreadPool();
+};
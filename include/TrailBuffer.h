@@ -0,0 +1,35 @@
+#pragma once
+
+// Library Includes
+#include <gtkmm.h>
+#include <cstdint>
+
+#include "PixelKernel.h"
+
+/**
+ * Persistence buffer for trails. Instead of replaying every old position,
+ *  moving things are stamped into an accumulation surface each frame, and
+ *  the whole surface is faded by the decay factor first. Trail length only
+ *  changes the decay, not the cost, which is one vectorized pass over the
+ *  pixels plus the stamps.
+ */
+class TrailBuffer {
+  private:        // Private Variables
+    Cairo::RefPtr<Cairo::ImageSurface>  surface;                // Premultiplied ARGB32, Empty until First Frame
+    Cairo::RefPtr<Cairo::Context>       stamp_ctx;              // Draws onto the Surface
+    uint32_t                            factor;                 // Decay in 1/256ths
+    FadeKernel                          fade;
+
+  public:         // Public Functions
+    // Fades the buffer once per step, recreating it cleared if the size changed.
+    void begin_frame(int width, int height, size_t steps = 1);
+    const Cairo::RefPtr<Cairo::Context> &get_context() const;   // Stamps go Here, Valid after begin_frame
+    void composite(const Cairo::RefPtr<Cairo::Context>&);       // Paints the Buffer onto the Context
+
+    void set_decay(double);                                     // Fraction Kept per Step, [0, 1]
+    double get_decay() const;
+    void clear();                                               // Erases all Trails
+
+  public:         // Constructor
+    TrailBuffer(double decay = 0.92);
+};
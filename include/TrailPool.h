@@ -0,0 +1,44 @@
+#pragma once
+
+// Library Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Physics.h"
+
+/**
+ * Fixed-Capacity Trail Ring Buffers for every Body, kept in one contiguous
+ *  pool. Body i owns the slots [i * capacity, (i + 1) * capacity). Pushing
+ *  onto a full trail overwrites its oldest point, so steady-state trails
+ *  never allocate.
+ */
+class TrailPool {
+  private:        // Private Variables
+    size_t                  capacity;                           // Points per Trail
+    std::vector<Vector2D>   points;                             // All Trails, Back to Back
+    std::vector<uint32_t>   heads;                              // Slot of the Oldest Point
+    std::vector<uint32_t>   counts;                             // Points in each Trail
+
+  public:         // Public Functions
+    size_t add();                                               // Adds an Empty Trail, Returns its Index
+    void clear();                                               // Removes all Trails
+    void push(size_t trail, Vector2D point);                    // Appends a Point, Dropping the Oldest if Full
+
+    // Updates a copy of source that is the given pushes per trail behind it.
+    void catch_up(const TrailPool &source, uint64_t pushes);
+
+    // Point k of a trail, 0 being the oldest.
+    inline Vector2D get(size_t trail, size_t k) const {
+      size_t slot = heads[trail] + k;
+      if (slot >= capacity) slot -= capacity;
+      return points[trail * capacity + slot];
+    }
+
+    size_t size(size_t trail) const;                            // Points in a Trail
+    size_t get_capacity() const;                                // Max Points per Trail
+    size_t get_trail_count() const;                             // Number of Trails
+
+  public:         // Constructor
+    TrailPool(size_t capacity = 32);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+// Library Includes
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Lock-Free Triple Buffer for handing the latest value from one writer
+ *  thread to one reader thread.
+ *
+ * The writer fills write_buffer() and publish()es it. The reader calls
+ *  update() to pick up the newest published value (if any) and reads it
+ *  through read_buffer(). Neither side ever blocks or waits for the other,
+ *  intermediate values the reader missed are simply skipped.
+ */
+template <typename T>
+class TripleBuffer {
+  private:        // Private Variables
+    static const uint8_t    INDEX_MASK = 3;
+    static const uint8_t    DIRTY = 4;                          // Middle holds an Unread Value
+
+    T                       buffers[3];
+    std::atomic<uint8_t>    middle;                             // Shared Slot Index | DIRTY
+    uint8_t                 back;                               // Writer's Slot
+    uint8_t                 front;                              // Reader's Slot
+
+  public:         // Writer Functions
+    /**
+     * @return Slot the writer fills next. Holds stale data, so overwrite it fully.
+     */
+    T &write_buffer() {
+      return buffers[back];
+    }
+
+    /**
+     * Publishes the write buffer, swapping it with the shared slot.
+     */
+    void publish() {
+      back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+  public:         // Reader Functions
+    /**
+     * Picks up the newest published value, if there is one.
+     *
+     * @return True if read_buffer() now holds a new value
+     */
+    bool update() {
+      if (!(middle.load(std::memory_order_acquire) & DIRTY))
+        return false;
+      front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+      return true;
+    }
+
+    /**
+     * @return Latest value picked up by update()
+     */
+    const T &read_buffer() const {
+      return buffers[front];
+    }
+
+  public:         // Constructor
+    TripleBuffer() : middle(1), back(0), front(2) {}
+};
@@ -0,0 +1,63 @@
+#include "BodyStore.h"
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Appends a body to the store.
+ *
+ * @param pos - Initial position
+ * @param mass - Body mass
+ * @param radius - Body radius
+ * @param velocity - Initial velocity
+ * @param acceleration - Initial acceleration, applied on the first step
+ * @return Index of the new body
+ */
+size_t BodyStore::add(Vector2D pos, double mass, double radius, Vector2D velocity, Vector2D acceleration) {
+  this->x.push_back(pos.x);
+  this->y.push_back(pos.y);
+  this->vx.push_back(velocity.x);
+  this->vy.push_back(velocity.y);
+  this->ax.push_back(acceleration.x);
+  this->ay.push_back(acceleration.y);
+  this->mass.push_back(mass);
+  this->radius.push_back(radius);
+  return this->x.size() - 1;
+}
+
+/**
+ * Reserves space for the given number of bodies.
+ *
+ * @param count - Number of bodies
+ */
+void BodyStore::reserve(size_t count) {
+  x.reserve(count);
+  y.reserve(count);
+  vx.reserve(count);
+  vy.reserve(count);
+  ax.reserve(count);
+  ay.reserve(count);
+  mass.reserve(count);
+  radius.reserve(count);
+}
+
+/**
+ * Removes all bodies from the store.
+ */
+void BodyStore::clear() {
+  x.clear();
+  y.clear();
+  vx.clear();
+  vy.clear();
+  ax.clear();
+  ay.clear();
+  mass.clear();
+  radius.clear();
+}
+
+/**
+ * @return Number of bodies in the store
+ */
+size_t BodyStore::size() const {
+  return x.size();
+}
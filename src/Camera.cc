@@ -0,0 +1,112 @@
+#include "Camera.h"
+#include <algorithm>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates a one to one camera with an empty viewport.
+ */
+Camera::Camera() {
+  width = height = 0;
+  revision = 0;
+  reset();
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+void Camera::update_view() {
+  view_left = origin_x;
+  view_top = origin_y;
+  view_right = origin_x + width / zoom;
+  view_bottom = origin_y + height / zoom;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * @param width - Screen width in pixels
+ * @param height - Screen height in pixels
+ */
+void Camera::set_viewport(int width, int height) {
+  this->width = width;
+  this->height = height;
+  update_view();
+}
+
+/**
+ * Moves the camera so the world point is at the center of the screen.
+ *
+ * @param x - World x-coordinate
+ * @param y - World y-coordinate
+ */
+void Camera::look_at(double x, double y) {
+  origin_x = x - width / (2.0 * zoom);
+  origin_y = y - height / (2.0 * zoom);
+  revision++;
+  update_view();
+}
+
+/**
+ * Moves the view, as if dragging the scene by the given screen distance.
+ *
+ * @param dx - Screen pixels to the right
+ * @param dy - Screen pixels down
+ */
+void Camera::pan(double dx, double dy) {
+  origin_x -= dx / zoom;
+  origin_y -= dy / zoom;
+  revision++;
+  update_view();
+}
+
+/**
+ * Multiplies the zoom by a factor, keeping the world point under the given
+ *  screen point in place (e.g. the mouse cursor).
+ *
+ * @param factor - Zoom multiplier, above 1 zooms in
+ * @param sx - Screen x-coordinate to zoom around
+ * @param sy - Screen y-coordinate to zoom around
+ */
+void Camera::zoom_at(double factor, double sx, double sy) {
+  if (!(factor > 0.0)) return;
+
+  double x, y;
+  to_world(sx, sy, x, y);
+  zoom = std::min(std::max(zoom * factor, MIN_ZOOM), MAX_ZOOM);
+  origin_x = x - sx / zoom;
+  origin_y = y - sy / zoom;
+  revision++;
+  update_view();
+}
+
+/**
+ * Maps world to screen one to one again.
+ */
+void Camera::reset() {
+  origin_x = origin_y = 0.0;
+  zoom = 1.0;
+  revision++;
+  update_view();
+}
+
+double Camera::get_zoom() const {
+  return zoom;
+}
+
+/**
+ * @return Counter bumped by look_at, pan, zoom_at and reset, so anything
+ *  cached in screen space can tell when it's stale
+ */
+uint64_t Camera::get_revision() const {
+  return revision;
+}
+
+void Camera::get_view(double &left, double &top, double &right, double &bottom) const {
+  left = view_left;
+  top = view_top;
+  right = view_right;
+  bottom = view_bottom;
+}
@@ -15,17 +15,62 @@ ContextArea::ContextArea() {
   // Make sure init_context_area is called
   is_init = false;
   setup_called = false;
+  offscreen = false;
 
   // SETUP VARIABLES
   frame_count = 0;
-  prev_time = std::chrono::high_resolution_clock::now();
-  elapsed_frames = 0;
+  prev_time = std::chrono::steady_clock::now();
+  setup_time = 0;
   fps = 0.0;
 
-  // SETUP GDK DEVICE MANAGER
+  target_fps = 0.0;
+  frame_interval = 0;
+  frame_origin = -1;
+  last_frame_index = 0;
+  missed_frames = 0;
+  tick_callback_id = 0;
+  on_demand = false;
+  redraw_requested = true;
+  woke_up = false;
+
+  batching = false;
+  sprites = false;
+
+  current_color = RgbaColor{ .r = 0.0, .g = 0.0, .b = 0.0, .a = 1.0 };
+  current_font_size = 10.0;
+
+  damage_tracking = false;
+  full_damage = true;
+  damage = Cairo::Region::create();
+
+  trail_camera_revision = camera.get_revision();
+
+  record_format = Y4M;
+  record_pending = false;
+
+  lod = LodPolicy{
+    .point_radius = 0.75,
+    .density_radius = 0.25,
+    .detail_radius = 4.0,
+    .density_color = RgbaColor{ .r = 1.0, .g = 1.0, .b = 1.0, .a = 1.0 },
+  };
+
+  // Evicted Resizes Won't be Drawn Again, so Drop their Surfaces too
+  resize_cache.set_on_evict([this](const GDK_IMAGE &img) { image_cache.forget(img); });
+
+  // Decoded Images Wake the Main Loop, Offscreen Frames Poll for them Instead.
+  //  Runs on decoder threads, hence the atomic flag: nothing drains the
+  //  dispatcher's pipe offscreen, so emitting there could fill it.
+  image_dispatcher.connect(sigc::mem_fun(*this, &ContextArea::deliver_images));
+  image_loader.set_on_decoded([this]() {
+    if (!offscreen)
+      image_dispatcher.emit();
+  });
+
+  // SETUP GDK DEVICE MANAGER: No Display when Rendering Offscreen
   display = gdk_display_get_default();
-  seat = gdk_display_get_default_seat(display);
-  device = gdk_seat_get_pointer(seat);
+  seat = display ? gdk_display_get_default_seat(display) : NULL;
+  device = seat ? gdk_seat_get_pointer(seat) : NULL;
 }
 
 /**
@@ -37,25 +82,26 @@ ContextArea::~ContextArea() {}
 /* PRIVATE CORE FUNCTIONS */
 
 /**
- * Keeps Track / Calculates Frames Per Second
+ * Keeps Track / Calculates Frames Per Second from the mean time between
+ *  recent frame starts. The first frame after an on-demand sleep starts a
+ *  new run, so the time spent asleep is never recorded as a frame.
+ *
+ * @param frame_start - Time the current frame started
  */
-void ContextArea::calc_frames_per_second() {
-  // GET fps
-  auto now = std::chrono::high_resolution_clock::now();
-  auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - prev_time);
-  if (elapsed.count() >= 1) {     // 1 Second Elapsed
-    prev_time = now;
-    if(elapsed_frames != 0) {    // No Div by 0, end of the world!
-      fps = elapsed_frames / elapsed.count();
-      elapsed_frames = 0;
+void ContextArea::calc_frames_per_second(CHRONO_HIGH_RES_CLOCK frame_start) {
+  if (frame_count > 0 && !woke_up)
+    frame_times.record(std::chrono::duration_cast<std::chrono::nanoseconds>(frame_start - prev_time).count());
+  prev_time = frame_start;
+  woke_up = false;
 
-      // DEBUG: Prints
-      #ifdef ENABLE_DEBUG_PRINTS
-        spdlog::info("fps [{:.2f}]", fps);
-      #endif
-    }
-  }
-  elapsed_frames++;
+  const double mean_ms = frame_times.mean_ms();
+  if (mean_ms > 0.0)      // No Div by 0, end of the world!
+    fps = 1000.0 / mean_ms;
+
+  // DEBUG: Prints
+  #ifdef ENABLE_DEBUG_PRINTS
+    spdlog::info("fps [{:.2f}]", fps);
+  #endif
 }
 
 
@@ -71,38 +117,179 @@ bool ContextArea::on_draw(const CAIRO_CTX_REF& cairo_ctx) {
   const int WIDTH = allocation.get_width();
   const int HEIGHT = allocation.get_height();
 
-  // CONSTRUCT CONTEXT
+  // CONSTRUCT CONTEXT: Recorded Frames are Drawn into the Capture Surface first
+  auto frame_start = std::chrono::steady_clock::now();
+  const bool capturing = is_recording();
+  const CAIRO_CTX_REF draw_ctx = capturing ? begin_capture(WIDTH, HEIGHT) : cairo_ctx;
   const Context ctx{
-    .cairo_ctx = cairo_ctx,
+    .cairo_ctx = draw_ctx,
     .width = WIDTH,
     .height = HEIGHT,
+    .camera = NULL,
   };
 
   // SETUP VIRTUAL FUNCTION
   if (!this->setup_called) {
     setup(ctx);
     this->setup_called = true;
+    setup_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame_start).count();
   }
 
   // CALL VIRTUAL DRAW
+  auto draw_start = std::chrono::steady_clock::now();
   draw(ctx);
+  flush_draw_list(ctx);
+  text_cache.end_frame();
+  draw_times.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - draw_start).count());
+
+  // RECORD: Queue a Copy, then Show the Frame
+  if (capturing) {
+    draw_ctx->restore();
+    capture_frame(capture_surface, false);
+    cairo_ctx->set_source(capture_surface, 0, 0);
+    cairo_ctx->paint();
+  }
 
   // COUNTER TRACK
-  calc_frames_per_second();
+  calc_frames_per_second(frame_start);
   frame_count++;
   return is_init;          // Makes sure everything running smoothly
 }
 
 /**
- * Forces Draw Area to Refresh
+ * Called by the frame clock once per display frame. Redraws when the next
+ *  frame of the target rate is due, so frames line up with vsync instead of
+ *  drifting against it. Frames are numbered from the first tick, and every
+ *  tick serves the frame nearest to it; any frame skipped over counts as a
+ *  missed deadline. In on-demand mode, the callback removes itself once a
+ *  tick finds no redraw requested.
+ *
+ * @param clock - Frame clock of the widget
+ * @return False to stop ticking
+ */
+bool ContextArea::on_tick(const Glib::RefPtr<Gdk::FrameClock>& clock) {
+  // ON DEMAND: Sleep until request_redraw
+  if (on_demand && !redraw_requested) {
+    tick_callback_id = 0;
+    return false;
+  }
+
+  // TARGET RATE: Wait for the Next Frame, Uncapped Draws Every Tick
+  if (frame_interval > 0) {
+    const gint64 now = clock->get_frame_time();
+    if (frame_origin < 0) {
+      frame_origin = now;
+      last_frame_index = 0;
+    } else {
+      const gint64 frame_index = (now - frame_origin + frame_interval / 2) / frame_interval;
+      if (frame_index <= last_frame_index)
+        return true;
+
+      missed_frames += frame_index - last_frame_index - 1;
+      last_frame_index = frame_index;
+    }
+  }
+
+  redraw_requested = false;
+  request_frame();
+  return true;
+}
+
+
+
+/**
+ * Lets the subclass update and report damage, then invalidates either the
+ *  reported damage or, without damage tracking, the whole area. Nothing is
+ *  redrawn when damage tracking is on and nothing was damaged.
  */
-bool ContextArea::on_timeout() {
+void ContextArea::request_frame() {
+  if (this->setup_called)
+    update();
+
+  if (!damage_tracking || full_damage || !this->setup_called) {
+    full_damage = false;
+    damage = Cairo::Region::create();
+    queue_draw();
+    return;
+  }
+  if (damage->empty()) return;
+
+  // GTK clips the on_draw context to the invalidated region.
   auto win = get_window();
-  if(win)
-    win->invalidate(false);
+  if (win)
+    win->invalidate_region(damage, false);
+  damage = Cairo::Region::create();
+}
+
+/**
+ * Offscreen counterpart of request_frame: clips the context to the damage
+ *  reported since the last frame, and resets it.
+ *
+ * @param cairo_ctx - Context to clip
+ * @return False if damage tracking is on and nothing was damaged
+ */
+bool ContextArea::take_damage(const CAIRO_CTX_REF& cairo_ctx) {
+  if (!damage_tracking || full_damage) {
+    full_damage = false;
+    damage = Cairo::Region::create();
+    return true;
+  }
+  if (damage->empty()) return false;
+
+  for (int i = 0; i < damage->get_num_rectangles(); i++) {
+    const Cairo::RectangleInt rect = damage->get_rectangle(i);
+    cairo_ctx->rectangle(rect.x, rect.y, rect.width, rect.height);
+  }
+  cairo_ctx->clip();
+  damage = Cairo::Region::create();
   return true;
 }
 
+/**
+ * Starts a windowed frame drawn into the capture surface, recreating it if
+ *  the size changed. Its content is kept between frames, so frames that
+ *  only redraw damaged areas are still captured whole.
+ *
+ * @param width - Width of the area
+ * @param height - Height of the area
+ * @return Context on the capture surface, restored by on_draw
+ */
+CAIRO_CTX_REF ContextArea::begin_capture(int width, int height) {
+  if (!capture_surface || capture_surface->get_width() != width || capture_surface->get_height() != height) {
+    capture_surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+    damage_all();
+  }
+  auto capture_ctx = Cairo::Context::create(capture_surface);
+  capture_ctx->save();
+  return capture_ctx;
+}
+
+/**
+ * Queues a finished frame for recording, starting the recorder at the
+ *  frame's size if recording was just requested.
+ *
+ * @param surface - Finished frame
+ * @param wait - True to wait for a free buffer rather than drop the frame
+ */
+void ContextArea::capture_frame(const Cairo::RefPtr<Cairo::ImageSurface> &surface, bool wait) {
+  surface->flush();
+  if (record_pending) {
+    record_pending = false;
+    const double fps = target_fps > 0.0 ? target_fps : 60.0;
+    recorder.start(record_path, record_format, surface->get_width(), surface->get_height(), fps);
+  }
+  recorder.capture(surface->get_data(), surface->get_width(), surface->get_height(), surface->get_stride(), wait);
+}
+
+/**
+ * Hands images decoded since the last call to their load_image handles, and
+ *  redraws everything if any arrived so they replace their placeholders.
+ */
+void ContextArea::deliver_images() {
+  if (image_loader.poll() > 0)
+    damage_all();
+}
+
 
 
 /* EVENT FUNCTIONS */
@@ -153,15 +340,53 @@ GDK_IMAGE ContextArea::create_image_buffer(std::string path) {
 }
 
 /**
- * Simple, Easy wrapper for Resizing Image
+ * Loads an Image without blocking, decoding it on a background thread. The
+ *  handle's get() returns the placeholder until the image is ready, at which
+ *  point the whole area is redrawn.
+ *
+ * @param path - Path to the Image
+ * @param placeholder - Image to draw until decoded, may be empty
+ * @return Handle to the Image
+ */
+IMAGE_HANDLE ContextArea::load_image(std::string path, GDK_IMAGE placeholder) {
+  return image_loader.load(path, placeholder);
+}
+
+/**
+ * Simple, Easy wrapper for Resizing Image. Results are cached, so resizing
+ *  the same image to the same size every frame only resamples it once.
  *
  * @param img - Reference to the Image that'll be resized
  * @param newWidth - New Width of Image
  * @param newHeight - New Height of Image
+ * @param filter - Resampling filter, NEAREST, BILINEAR or LANCZOS
  * @return New GDK_IMAGE of Resized Image
  */
-GDK_IMAGE ContextArea::resize_image(const GDK_IMAGE& img, int newWidth, int newHeight) {
-  return img->scale_simple(newWidth, newHeight, Gdk::InterpType::INTERP_NEAREST);
+GDK_IMAGE ContextArea::resize_image(const GDK_IMAGE& img, int newWidth, int newHeight, RESAMPLE_FILTER filter) {
+  GDK_IMAGE resized = resize_cache.resize(img, newWidth, newHeight, filter);
+  if (!resized)
+    return img->scale_simple(newWidth, newHeight, filter == NEAREST ? Gdk::InterpType::INTERP_NEAREST : Gdk::InterpType::INTERP_BILINEAR);
+  return resized;
+}
+
+/**
+ * Sets how many bytes of resized images resize_image keeps, evicting the
+ *  least recently used ones past it.
+ *
+ * @param bytes - Memory budget in bytes
+ */
+void ContextArea::set_resize_cache_budget(size_t bytes) {
+  resize_cache.set_budget(bytes);
+}
+
+/**
+ * Sets how many bytes of uploaded image surfaces draw_image keeps, evicting
+ *  the least recently drawn ones past it.
+ *
+ * @param bytes - Memory budget in bytes
+ */
+void ContextArea::set_image_cache_budget(size_t bytes) {
+  image_cache.set_budget(bytes);
 }
 
 /**
@@ -169,12 +394,59 @@ GDK_IMAGE ContextArea::resize_image(const GDK_IMAGE& img, int newWidth, int newH
  *  is.
  *
  * @param ctx - Cario Drawing Context
- * @param path - Image Path
+ * @param img - Image Buffer
  */
 void ContextArea::draw_image(const Context& ctx, GDK_IMAGE img) {
-  Gdk::Cairo::set_source_pixbuf(ctx.cairo_ctx, img, 0, 0);
-  ctx.cairo_ctx->rectangle(0, 0, img->get_width(), img->get_height());
+  draw_image(ctx, img, 0, 0, img->get_width(), img->get_height());
+}
+
+/**
+ * Draws Given Image scaled to fill the given rectangle. The image is
+ *  converted to a Cairo surface on first draw and reused afterwards.
+ *
+ * @param ctx - Cario Drawing Context
+ * @param img - Image Buffer
+ * @param x - Left of the rectangle
+ * @param y - Top of the rectangle
+ * @param width - Width to draw the image at
+ * @param height - Height to draw the image at
+ */
+void ContextArea::draw_image(const Context& ctx, GDK_IMAGE img, double x, double y, double width, double height) {
+  const int img_width = img->get_width();
+  const int img_height = img->get_height();
+  if (img_width <= 0 || img_height <= 0 || !(width > 0.0) || !(height > 0.0)) return;
+
+  if (ctx.camera) {
+    if (!ctx.camera->is_visible(x, y, x + width, y + height)) return;
+    ctx.camera->to_screen(x, y, x, y);
+    width *= ctx.camera->get_zoom();
+    height *= ctx.camera->get_zoom();
+  }
+
+  // Primitives Recorded so far Belong Below the Image
+  flush_draw_list(ctx);
+  ctx.cairo_ctx->save();
+  ctx.cairo_ctx->translate(x, y);
+  ctx.cairo_ctx->scale(width / img_width, height / img_height);
+
+  auto surface = image_cache.get_surface(img);
+  if (surface)
+    ctx.cairo_ctx->set_source(surface, 0, 0);
+  else
+    Gdk::Cairo::set_source_pixbuf(ctx.cairo_ctx, img, 0, 0);
+
+  ctx.cairo_ctx->rectangle(0, 0, img_width, img_height);
   ctx.cairo_ctx->fill();
+  ctx.cairo_ctx->restore();
+}
+
+/**
+ * Drops the cached surface of an image, for after its pixels changed.
+ *
+ * @param img - Image Buffer
+ */
+void ContextArea::forget_image(GDK_IMAGE img) {
+  image_cache.forget(img);
 }
 
 /**
@@ -184,12 +456,243 @@ void ContextArea::draw_image(const Context& ctx, GDK_IMAGE img) {
  * @param color - RgbaColor struct.
  */
 void ContextArea::background(const Context& ctx, RgbaColor color) {
+  // Primitives Recorded so far Belong Below the Background
+  flush_draw_list(ctx);
+
   // Draw Background Color
   ctx.cairo_ctx->set_source_rgba(color.r, color.g, color.b, color.a);
   ctx.cairo_ctx->rectangle(0, 0, ctx.width, ctx.height);
   ctx.cairo_ctx->fill();
 }
 
+/**
+ * Adds a static layer with its own backing surface. The function draws the
+ *  layer's content onto a transparent surface the size of the area; it's
+ *  only called again when the area is resized or the layer is invalidated.
+ *
+ * @param draw - Draws the layer, may use any of the drawing helpers
+ * @return Index of the layer, for draw_layer and invalidate_layer
+ */
+size_t ContextArea::add_layer(std::function<void(const Context&)> draw) {
+  return layers.add([this, draw](const CAIRO_CTX_REF &layer_ctx, int width, int height) {
+    const Context ctx{
+      .cairo_ctx = layer_ctx,
+      .width = width,
+      .height = height,
+      .camera = NULL,                                           // Static, so never Follows the Camera
+    };
+    draw(ctx);
+    flush_draw_list(ctx);
+  });
+}
+
+/**
+ * Composites a layer with a single paint, re-drawing it first if it was
+ *  invalidated or the area was resized. Primitives recorded before the
+ *  call are flushed first so the layer lands above them.
+ *
+ * @param ctx - Drawing Context
+ * @param layer - Index from add_layer
+ */
+void ContextArea::draw_layer(const Context& ctx, size_t layer) {
+  flush_draw_list(ctx);
+  layers.composite(ctx.cairo_ctx, layer, ctx.width, ctx.height);
+}
+
+/**
+ * Marks a layer's content as changed, so it's re-drawn on its next
+ *  draw_layer, and schedules a full redraw.
+ *
+ * @param layer - Index from add_layer
+ */
+void ContextArea::invalidate_layer(size_t layer) {
+  layers.invalidate(layer);
+  damage_all();
+}
+
+/**
+ * Returns a copy of the context whose helpers (circle, line, draw_text
+ *  and draw_image) take world coordinates, mapped through the camera.
+ *  Anything entirely off screen is skipped before any Cairo call, so
+ *  zoomed-in views only pay for what's visible. Sizes scale with the zoom,
+ *  except text, which stays readable.
+ *
+ * @param ctx - Screen Drawing Context
+ * @return World Drawing Context
+ */
+Context ContextArea::world_context(const Context& ctx) {
+  camera.set_viewport(ctx.width, ctx.height);
+  return Context{
+    .cairo_ctx = ctx.cairo_ctx,
+    .width = ctx.width,
+    .height = ctx.height,
+    .camera = &camera,
+  };
+}
+
+Camera &ContextArea::get_camera() {
+  return camera;
+}
+
+/**
+ * Draws many bodies, each at the level of detail its size on screen calls
+ *  for. Bodies big enough are circles (culled and batched as usual), small
+ *  ones single pixels, and the smallest only raise the density of their
+ *  pixel, drawn once for all of them in the policy's density_color. Pixels
+ *  and density share one framebuffer pass, so a zoomed-out view of a huge
+ *  scene costs about as much as its pixel count.
+ *
+ * Discs are drawn in a first pass and the framebuffer in a second, so pixels
+ *  always land above discs whatever order the bodies come in.
+ *
+ * @param ctx - Drawing Context, world or screen
+ * @param x - x-coordinates of the centers
+ * @param y - y-coordinates of the centers
+ * @param r - Radii
+ * @param colors - Color of each body, unused for LOD_DENSITY bodies
+ * @param count - Number of bodies
+ */
+void ContextArea::draw_bodies(const Context& ctx, const double *x, const double *y, const double *r, const RgbaColor *colors, size_t count) {
+  const double zoom = ctx.camera ? ctx.camera->get_zoom() : 1.0;
+
+  // DISC PASS: Remembers whether any Body Needs the Framebuffer
+  bool has_small = false;
+  for (size_t i = 0; i < count; i++) {
+    if (r[i] * zoom >= lod.point_radius)
+      circle(ctx, x[i], y[i], r[i], colors[i]);
+    else
+      has_small = true;
+  }
+  if (!has_small) return;
+
+  // PIXEL PASS: Flushes the Discs beneath the Framebuffer
+  begin_pixels(ctx);
+  density.begin(ctx.width, ctx.height);
+  for (size_t i = 0; i < count; i++) {
+    const double projected = r[i] * zoom;
+    if (projected >= lod.point_radius) continue;
+
+    double sx = x[i], sy = y[i];
+    if (ctx.camera)
+      ctx.camera->to_screen(x[i], y[i], sx, sy);
+    if (!(sx >= 0.0 && sx < ctx.width && sy >= 0.0 && sy < ctx.height)) continue;
+
+    if (projected >= lod.density_radius)
+      pixel_buffer.point(sx, sy, colors[i]);
+    else
+      density.add((int)sx, (int)sy);
+  }
+
+  density.resolve(pixel_buffer, lod.density_color);
+  end_pixels(ctx);
+}
+
+/**
+ * @param ctx - Drawing Context, world or screen
+ * @param r - Radius of the body in the context's coordinates
+ * @return Level of detail draw_bodies uses for it
+ */
+BODY_LOD ContextArea::get_body_lod(const Context& ctx, double r) const {
+  const double projected = r * (ctx.camera ? ctx.camera->get_zoom() : 1.0);
+  if (projected >= lod.point_radius) return LOD_DISC;
+  if (projected >= lod.density_radius) return LOD_POINT;
+  return LOD_DENSITY;
+}
+
+/**
+ * @param ctx - Drawing Context, world or screen
+ * @param r - Radius of the body in the context's coordinates
+ * @return True if the body is big enough on screen for labels and arrows
+ */
+bool ContextArea::shows_detail(const Context& ctx, double r) const {
+  return r * (ctx.camera ? ctx.camera->get_zoom() : 1.0) >= lod.detail_radius;
+}
+
+void ContextArea::set_lod_policy(const LodPolicy &policy) {
+  lod = policy;
+}
+
+const LodPolicy &ContextArea::get_lod_policy() const {
+  return lod;
+}
+
+/**
+ * Starts a framebuffer pass. Points, discs and rectangles splatted into the
+ *  returned buffer skip Cairo's path machinery entirely, which pays off for
+ *  thousands of tiny particles. Primitives recorded so far are flushed so
+ *  they stay beneath it. Finish with end_pixels.
+ *
+ * @param ctx - Drawing Context
+ * @return Framebuffer cleared to transparent, the size of the area
+ */
+PixelBuffer &ContextArea::begin_pixels(const Context& ctx) {
+  flush_draw_list(ctx);
+  pixel_buffer.begin(ctx.width, ctx.height);
+  return pixel_buffer;
+}
+
+/**
+ * Composites the framebuffer over the context with one paint. Cairo drawing
+ *  after it lands on top.
+ *
+ * @param ctx - Drawing Context
+ */
+void ContextArea::end_pixels(const Context& ctx) {
+  pixel_buffer.composite(ctx.cairo_ctx);
+}
+
+/**
+ * Draws persistent trails: the trail buffer is faded by the decay factor
+ *  once per step, the stamp function draws the new positions into it, and
+ *  the result is painted with one paint. The cost doesn't depend on trail
+ *  length. Passing the steps taken since the last call keeps trail length
+ *  independent of the frame rate; with none, the buffer is only painted. The
+ *  whole buffer changes every frame, so damage it all when tracking damage.
+ *
+ * The buffer is in screen pixels, so it's cleared whenever the camera has
+ *  moved or zoomed since the last stamp, rather than smearing old trails.
+ *
+ * @param ctx - Drawing Context
+ * @param stamp - Draws onto the trail buffer, may use any of the drawing helpers
+ * @param steps - Simulation steps since the last call, 0 to only paint
+ */
+void ContextArea::draw_trail_buffer(const Context& ctx, std::function<void(const Context&)> stamp, size_t steps) {
+  if (ctx.camera && ctx.camera->get_revision() != trail_camera_revision) {
+    trail_camera_revision = ctx.camera->get_revision();
+    trail_buffer.clear();
+  }
+  // Primitives Recorded so far Belong Below the Trails
+  flush_draw_list(ctx);
+  if (steps == 0) {
+    trail_buffer.composite(ctx.cairo_ctx);
+    return;
+  }
+
+  trail_buffer.begin_frame(ctx.width, ctx.height, steps);
+  const Context trail_ctx{
+    .cairo_ctx = trail_buffer.get_context(),
+    .width = ctx.width,
+    .height = ctx.height,
+    .camera = ctx.camera,
+  };
+  if (!trail_ctx.cairo_ctx) return;
+
+  stamp(trail_ctx);
+  flush_draw_list(trail_ctx);
+  trail_buffer.composite(ctx.cairo_ctx);
+}
+
+/**
+ * @param decay - Fraction of the trail buffer kept each step, in [0, 1]
+ */
+void ContextArea::set_trail_decay(double decay) {
+  trail_buffer.set_decay(decay);
+}
+
+void ContextArea::clear_trail_buffer() {
+  trail_buffer.clear();
+}
+
 /**
  * Draws circle at given coordinates.
  *
@@ -200,11 +703,60 @@ void ContextArea::background(const Context& ctx, RgbaColor color) {
  * @param color - RgbaColor struct.
  */
 void ContextArea::circle(const Context& ctx, double x, double y, double r, const RgbaColor &color) {
+  if (ctx.camera) {
+    if (!ctx.camera->is_visible(x, y, r)) return;
+    ctx.camera->to_screen(x, y, x, y);
+    r *= ctx.camera->get_zoom();
+  }
+
+  if (batching) {
+    draw_list.set_color(color);
+    draw_list.circle(x, y, r);
+    return;
+  }
+  if (sprites && sprite_cache.draw_circle(ctx.cairo_ctx, x, y, r, color))
+    return;
+
   set_color(ctx, color);
   ctx.cairo_ctx->arc(x, y, r, 0, M_PI*2);
   ctx.cairo_ctx->fill();
 }
 
+/**
+ * Draws a round-capped line between the given coordinates.
+ *
+ * @param ctx - Drawing Context
+ * @param x1 - Start x-coordinate.
+ * @param y1 - Start y-coordinate.
+ * @param x2 - End x-coordinate.
+ * @param y2 - End y-coordinate.
+ * @param width - Line width.
+ * @param color - RgbaColor struct.
+ */
+void ContextArea::line(const Context& ctx, double x1, double y1, double x2, double y2, double width, const RgbaColor &color) {
+  if (ctx.camera) {
+    const double pad = width / 2.0;
+    if (!ctx.camera->is_visible(std::min(x1, x2) - pad, std::min(y1, y2) - pad, std::max(x1, x2) + pad, std::max(y1, y2) + pad)) return;
+    ctx.camera->to_screen(x1, y1, x1, y1);
+    ctx.camera->to_screen(x2, y2, x2, y2);
+    width *= ctx.camera->get_zoom();
+  }
+
+  if (batching) {
+    draw_list.set_color(color);
+    draw_list.set_line_width(width);
+    draw_list.line(x1, y1, x2, y2);
+    return;
+  }
+
+  set_color(ctx, color);
+  ctx.cairo_ctx->set_line_width(width);
+  ctx.cairo_ctx->set_line_cap(Cairo::LINE_CAP_ROUND);
+  ctx.cairo_ctx->move_to(x1, y1);
+  ctx.cairo_ctx->line_to(x2, y2);
+  ctx.cairo_ctx->stroke();
+}
+
 /**
  * Sets drawing context color.
  *
@@ -213,6 +765,8 @@ void ContextArea::circle(const Context& ctx, double x, double y, double r, const
  */
 void ContextArea::set_color(const Context& ctx, const RgbaColor &color) {
   ctx.cairo_ctx->set_source_rgba(color.r, color.g, color.b, color.a);
+  draw_list.set_color(color);
+  current_color = color;
 }
 
 /**
@@ -223,6 +777,8 @@ void ContextArea::set_color(const Context& ctx, const RgbaColor &color) {
  */
 void ContextArea::set_font_size(const Context& ctx, double size) {
   ctx.cairo_ctx->set_font_size(size);
+  draw_list.set_font_size(size);
+  current_font_size = size;
 }
 
 /**
@@ -234,50 +790,211 @@ void ContextArea::set_font_size(const Context& ctx, double size) {
  * @param text - Text to draw.
  */
 void ContextArea::draw_text(const Context& ctx, double x, double y, const char* text) {
-  ctx.cairo_ctx->select_font_face("Sans", Cairo::FONT_SLANT_NORMAL, Cairo::FONT_WEIGHT_NORMAL);
-  ctx.cairo_ctx->move_to(x, y);
-  ctx.cairo_ctx->show_text(text);
+  // WORLD: Anchor Follows the Camera, Text Keeps its Size
+  if (ctx.camera) {
+    ctx.camera->to_screen(x, y, x, y);
+    const Cairo::TextExtents &extents = get_text_extents(ctx, text);
+    if (x + extents.x_bearing + extents.width < 0.0 || x + extents.x_bearing > ctx.width ||
+        y + extents.y_bearing + extents.height < 0.0 || y + extents.y_bearing > ctx.height) return;
+  }
+
+  if (batching) {
+    draw_list.text(x, y, text);
+    return;
+  }
+
+  text_cache.draw_text(ctx.cairo_ctx, x, y, text, current_font_size, current_color);
+}
+
+/**
+ * Measures text in the current font size. Extents are cached, so repeating
+ *  text is only measured once.
+ *
+ * @param ctx - Drawing Context.
+ * @param text - Text to measure.
+ * @return Extents of the text, valid for the rest of the frame
+ */
+const Cairo::TextExtents &ContextArea::get_text_extents(const Context& ctx, const char* text) {
+  return text_cache.get_extents(ctx.cairo_ctx, text, current_font_size);
 }
 
 /**
  * Draws drawing statistics on the top right of the window.
  *  - fps
  *  - Window dimensions
+ *  - Target fps and missed frames
+ *  - Frame, draw, setup and (if given) physics times
  *
  * @param ctx - Drawing Context.
+ * @param physics - Physics step times, NULL to leave out
  */
-void ContextArea::display_nerd_info(const Context& ctx) {
+void ContextArea::display_nerd_info(const Context& ctx, const FrameStats::Summary *physics) {
   const double font_size = 20.0;
-  set_color(ctx, RgbaColor{ .r = 3.0, .a = 1.0 });
+  set_color(ctx, RgbaColor{ .r = 3.0, .g = 0.0, .b = 0.0, .a = 1.0 });
   set_font_size(ctx, font_size);
 
-  // Store the extents of a text in order to grab the dimensions.
-  Cairo::TextExtents f_extents;
-
   // DRAW fps COUNTER.
   // Interpret fps double as a string.
   char fps_buffer[255];
-  int bytes_written = snprintf(fps_buffer, sizeof(fps_buffer), "fps: %.2f", this->get_fps());
+  snprintf(fps_buffer, sizeof(fps_buffer), "fps: %.2f", this->get_fps());
 
-  ctx.cairo_ctx->get_text_extents(fps_buffer, f_extents);
-  draw_text(ctx, ctx.width - (f_extents.width + 5.f), font_size, fps_buffer);
+  const Cairo::TextExtents &fps_extents = get_text_extents(ctx, fps_buffer);
+  draw_text(ctx, ctx.width - (fps_extents.width + 5.f), font_size, fps_buffer);
 
   // DRAW WINDOW DIMENSIONS.
   char dim_buffer[255];
-  bytes_written = snprintf(dim_buffer, sizeof(dim_buffer), "Window: width[%d] height[%d]", ctx.width, ctx.height);
+  snprintf(dim_buffer, sizeof(dim_buffer), "Window: width[%d] height[%d]", ctx.width, ctx.height);
+
+  const Cairo::TextExtents &dim_extents = get_text_extents(ctx, dim_buffer);
+  draw_text(ctx, ctx.width - (dim_extents.width + 5.f), font_size + font_size + 2.0, dim_buffer);
+
+  // DRAW FRAME SCHEDULE.
+  char target_buffer[255];
+  if (this->target_fps > 0.0)
+    snprintf(target_buffer, sizeof(target_buffer), "target: %.1f fps | missed: %llu", this->target_fps, this->missed_frames);
+  else
+    snprintf(target_buffer, sizeof(target_buffer), "target: uncapped");
+
+  const Cairo::TextExtents &target_extents = get_text_extents(ctx, target_buffer);
+  draw_text(ctx, ctx.width - (target_extents.width + 5.f), (font_size + 2.0) * 3.0, target_buffer);
+
+  // DRAW FRAME TIMES.
+  const FrameStats::Summary frame = frame_times.summary();
+  char frame_buffer[255];
+  snprintf(frame_buffer, sizeof(frame_buffer), "frame ms: p50[%.2f] p95[%.2f] p99[%.2f] max[%.2f]",
+    frame.p50_ms, frame.p95_ms, frame.p99_ms, frame.max_ms);
 
-  ctx.cairo_ctx->get_text_extents(dim_buffer, f_extents);
-  draw_text(ctx, ctx.width - (f_extents.width + 5.f), font_size + font_size + 2.0, dim_buffer);
+  const Cairo::TextExtents &frame_extents = get_text_extents(ctx, frame_buffer);
+  draw_text(ctx, ctx.width - (frame_extents.width + 5.f), (font_size + 2.0) * 4.0, frame_buffer);
+
+  // DRAW SETUP + DRAW TIMES.
+  const FrameStats::Summary drawing = draw_times.summary();
+  char draw_buffer[255];
+  snprintf(draw_buffer, sizeof(draw_buffer), "draw ms: mean[%.2f] p99[%.2f] | setup ms: %.2f",
+    drawing.mean_ms, drawing.p99_ms, get_setup_time());
+
+  const Cairo::TextExtents &draw_extents = get_text_extents(ctx, draw_buffer);
+  draw_text(ctx, ctx.width - (draw_extents.width + 5.f), (font_size + 2.0) * 5.0, draw_buffer);
+
+  // DRAW PHYSICS TIMES.
+  if (physics) {
+    char physics_buffer[255];
+    snprintf(physics_buffer, sizeof(physics_buffer), "physics ms: mean[%.2f] p99[%.2f]",
+      physics->mean_ms, physics->p99_ms);
+
+    const Cairo::TextExtents &physics_extents = get_text_extents(ctx, physics_buffer);
+    draw_text(ctx, ctx.width - (physics_extents.width + 5.f), (font_size + 2.0) * 6.0, physics_buffer);
+  }
 }
 
 
 /* SHARED FUNCTIONS */
 
-void ContextArea::setup(const Context& ctx) {
+void ContextArea::setup(const Context&) {
   spdlog::info("Default Setup");
 }
 
-void ContextArea::draw(const Context& ctx) {}
+void ContextArea::draw(const Context&) {}
+
+/**
+ * Called once per scheduled frame before it is drawn, after setup. Update
+ *  state and, with damage tracking on, report what changed through
+ *  add_damage: both where a moved object was and where it now is.
+ */
+void ContextArea::update() {}
+
+/**
+ * @return True while frames are rendered by render_offscreen instead of GTK
+ */
+bool ContextArea::is_offscreen() const {
+  return offscreen;
+}
+
+/**
+ * When enabled, circle, line and draw_text record into a per-frame list
+ *  instead of drawing. The list is flushed after draw, or earlier with
+ *  flush_draw_list, sorted so each color/width/font is set once and merged
+ *  into as few fills and strokes as possible. Recorded primitives land above
+ *  anything drawn directly since the last flush; background, draw_image and
+ *  the layer helpers flush first to keep the order.
+ *
+ * The list is drawn with the transform and clip in effect at flush time,
+ *  so leave the Cairo context's transform and clip alone while batching
+ *  (or flush before changing them). The camera is fine, it maps
+ *  coordinates before they're recorded.
+ *
+ * @param enable - True to record, False to draw immediately
+ */
+void ContextArea::enable_draw_batching(bool enable) {
+  batching = enable;
+}
+
+/**
+ * When enabled, frames are only drawn where add_damage reported changes
+ *  (report them from update), and draw is clipped to that region. Frames
+ *  with no damage are skipped entirely. The first frame and damage_all
+ *  redraw everything.
+ *
+ * @param enable - True to redraw damaged areas only, False to redraw everything
+ */
+void ContextArea::enable_damage_tracking(bool enable) {
+  damage_tracking = enable;
+  damage_all();
+}
+
+/**
+ * Marks an area to be redrawn by the next frame, rounded out to whole pixels.
+ *
+ * @param x - Left of the area
+ * @param y - Top of the area
+ * @param width - Width of the area
+ * @param height - Height of the area
+ */
+void ContextArea::add_damage(double x, double y, double width, double height) {
+  if (!(width > 0.0) || !(height > 0.0)) return;
+
+  const int left = (int)std::floor(x);
+  const int top = (int)std::floor(y);
+  damage->do_union(Cairo::RectangleInt{
+    .x = left,
+    .y = top,
+    .width = (int)std::ceil(x + width) - left,
+    .height = (int)std::ceil(y + height) - top,
+  });
+  request_redraw();
+}
+
+/**
+ * Marks the whole area to be redrawn by the next frame.
+ */
+void ContextArea::damage_all() {
+  full_damage = true;
+  request_redraw();
+}
+
+/**
+ * Draws every primitive recorded since the last flush.
+ *
+ * @param ctx - Drawing Context
+ */
+void ContextArea::flush_draw_list(const Context& ctx) {
+  if (draw_list.size() > 0)
+    draw_list.flush(ctx.cairo_ctx, sprites ? &sprite_cache : NULL, &text_cache);
+}
+
+/**
+ * When enabled, circles (drawn directly or from the draw list) are blitted
+ *  from pre-rasterized sprites, keyed by quantized radius, color and device
+ *  scale, instead of tessellating an arc each time. Centers snap to whole
+ *  device pixels.
+ *
+ * @param enable - True to use sprites, False to always draw arcs
+ */
+void ContextArea::enable_circle_sprites(bool enable) {
+  sprites = enable;
+  if (!sprites)
+    sprite_cache.clear();
+}
 
 
 
@@ -288,13 +1005,7 @@ void ContextArea::draw(const Context& ctx) {}
  *  with fps Target to 30 fps
  */
 void ContextArea::init_context_area() {
-  // Functionality Should work Properly!
-  is_init = true;
-
-  Glib::signal_timeout().connect(
-    sigc::mem_fun(*this, &ContextArea::on_timeout),
-    34
-  );
+  init_context_area(30.0);
 }
 
 /**
@@ -304,42 +1015,125 @@ void ContextArea::init_context_area() {
  * @param targetFPS - Enumerator for Targeted fps
  */
 void ContextArea::init_context_area(TARGET_FPS targetFPS) {
-  // Functionality Should work Properly!
-  is_init = true;
-
   // Figure out the Target fps
-  unsigned int fps_interval;
   switch(targetFPS) {
     case FIFTEEN:
-        fps_interval = 68;
+        init_context_area(15.0);
         break;
     case THIRTY:
-        fps_interval = 34;
+        init_context_area(30.0);
         break;
     case SIXTY:
-        fps_interval = 16;
+        init_context_area(60.0);
+        break;
+    case UNCAPPED:
+        init_context_area(0.0);
         break;
     default:
-        fps_interval = 34;
+        init_context_area(30.0);
         break;
   }
+}
 
+/**
+ * Initiates everything requried to run properly
+ *  with Given fps Target. Redraws are driven by the widget's frame clock.
+ *
+ * @param targetFPS - Targeted fps, 0 to redraw on every frame clock tick
+ */
+void ContextArea::init_context_area(double targetFPS) {
+  // Functionality Should work Properly!
+  is_init = true;
+  set_target_fps(targetFPS);
 
   // Set "Draw Refresh Rate"
-  Glib::signal_timeout().connect(
-    sigc::mem_fun(*this, &ContextArea::on_timeout),
-    fps_interval
-  );
+  request_redraw();
+}
+
+/**
+ * Changes the fps Target, restarting the frame schedule and missed frame
+ *  count.
+ *
+ * @param targetFPS - Targeted fps, 0 (or less) to redraw on every frame clock tick
+ */
+void ContextArea::set_target_fps(double targetFPS) {
+  target_fps = targetFPS > 0.0 ? targetFPS : 0.0;
+  frame_interval = target_fps > 0.0 ? (gint64)std::llround(1e6 / target_fps) : 0;
+  frame_origin = -1;
+  missed_frames = 0;
+}
+
+/**
+ * In on-demand mode frames are only drawn after request_redraw (or
+ *  add_damage), and the frame clock callback is removed while nothing is
+ *  requested, so a static scene uses no CPU. Input events forwarded by
+ *  MyWindow request a redraw. Animating subclasses keep it awake by calling
+ *  request_redraw from update or draw.
+ *
+ * @param enable - True for on-demand, False to redraw at the target rate
+ */
+void ContextArea::enable_on_demand(bool enable) {
+  on_demand = enable;
+  request_redraw();
+}
+
+/**
+ * Schedules a frame, re-attaching the frame clock callback if it stopped.
+ *  The frame schedule and frame timing restart on wake, so time spent asleep
+ *  counts neither as missed frames nor in the frame times.
+ */
+void ContextArea::request_redraw() {
+  redraw_requested = true;
+  if (!is_init || tick_callback_id != 0) return;
+
+  frame_origin = -1;
+  woke_up = true;
+  tick_callback_id = add_tick_callback(sigc::mem_fun(*this, &ContextArea::on_tick));
 }
 
+/**
+ * @return Targeted fps, 0 if Uncapped
+ */
+double ContextArea::get_target_fps() const {
+  return target_fps;
+}
+
+/**
+ * @return Frames the target rate scheduled that were never drawn, since the
+ *  target was last set
+ */
+unsigned long long ContextArea::get_missed_frames() const {
+  return missed_frames;
+}
 
 /**
  * @return Calculated Frames Per Second
  */
-const double ContextArea::get_fps() {
+double ContextArea::get_fps() {
   return fps;
 }
 
+/**
+ * @return Statistics of the time between recent frame starts
+ */
+FrameStats::Summary ContextArea::get_frame_stats() const {
+  return frame_times.summary();
+}
+
+/**
+ * @return Statistics of recent draw call durations
+ */
+FrameStats::Summary ContextArea::get_draw_stats() const {
+  return draw_times.summary();
+}
+
+/**
+ * @return Duration of the setup call in milliseconds, 0 before it runs
+ */
+double ContextArea::get_setup_time() const {
+  return setup_time / 1e6;
+}
+
 /**
  * Simple Wrapper for getting Mouse Position
  *
@@ -347,5 +1141,143 @@ const double ContextArea::get_fps() {
  * @param y - Reference to y-position of Mouse (Will be stored)
  */
 void ContextArea::get_mouse_position(double &x, double &y) {
+  if (!this->device) {
+    x = y = 0.0;
+    return;
+  }
   gdk_device_get_position_double(this->device, NULL, &x, &y);
 }
+
+/**
+ * Starts recording every frame, picking the format from the extension:
+ *  ".y4m" for Y4M video, ".rgba" or ".raw" for raw RGBA frames, anything
+ *  else as the prefix of a PNG sequence.
+ *
+ * @param path - Output path
+ */
+void ContextArea::start_recording(const std::string &path) {
+  start_recording(path, FrameRecorder::format_for_path(path));
+}
+
+/**
+ * Starts recording from the next frame on, at that frame's size. Frames are
+ *  copied into pooled buffers and written by a background thread. Windowed
+ *  frames are dropped (and counted) if the encoder falls a whole pool
+ *  behind; offscreen frames wait for it instead, so offscreen recordings are
+ *  always complete.
+ *
+ * @param path - Output file, or file name prefix for PNG sequences
+ * @param format - Output format
+ */
+void ContextArea::start_recording(const std::string &path, RECORD_FORMAT format) {
+  stop_recording();
+  record_path = path;
+  record_format = format;
+  record_pending = true;
+  request_redraw();
+}
+
+/**
+ * Stops recording once every captured frame is written.
+ */
+void ContextArea::stop_recording() {
+  record_pending = false;
+  recorder.stop();
+  capture_surface = Cairo::RefPtr<Cairo::ImageSurface>();
+}
+
+bool ContextArea::is_recording() const {
+  return record_pending || recorder.is_recording();
+}
+
+/**
+ * Renders frames into an offscreen image surface as fast as possible, without
+ *  a window or display server. setup() is called once, then update() and
+ *  draw() for every frame, each starting from a clean drawing state.
+ *
+ * update() (where an app steps its simulation) is timed apart from drawing,
+ *  so the returned times are rendering alone; its mean is only logged.
+ *
+ * @param width - Surface width
+ * @param height - Surface height
+ * @param frames - Number of frames to render
+ * @param png_path - If not empty, the last frame is written there as a PNG
+ * @return Draw time of every frame in milliseconds
+ */
+std::vector<double> ContextArea::render_offscreen(int width, int height, size_t frames, const std::string &png_path) {
+  offscreen = true;
+
+  // CONSTRUCT CONTEXT: Backed by an Image Surface
+  auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+  auto cairo_ctx = Cairo::Context::create(surface);
+  const Context ctx{
+    .cairo_ctx = cairo_ctx,
+    .width = width,
+    .height = height,
+    .camera = NULL,
+  };
+
+  // SETUP VIRTUAL FUNCTION
+  if (!this->setup_called) {
+    auto start = std::chrono::steady_clock::now();
+    setup(ctx);
+    this->setup_called = true;
+    setup_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  std::vector<double> frame_times;
+  frame_times.reserve(frames);
+  double update_total = 0.0;
+  for (size_t i = 0; i < frames; i++) {
+    // UPDATE: Timed on its Own
+    auto update_start = std::chrono::steady_clock::now();
+    deliver_images();
+    update();
+    auto start = std::chrono::steady_clock::now();
+    update_total += std::chrono::duration<double, std::milli>(start - update_start).count();
+
+    cairo_ctx->save();
+    if (!take_damage(cairo_ctx)) {
+      cairo_ctx->restore();
+      frame_times.push_back(0.0);
+      if (is_recording())
+        capture_frame(surface, true);                           // Unchanged, but Still a Frame
+      continue;
+    }
+    draw(ctx);
+    flush_draw_list(ctx);
+    text_cache.end_frame();
+    cairo_ctx->restore();
+    surface->flush();
+    auto end = std::chrono::steady_clock::now();
+    frame_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    draw_times.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+    // RECORD: Waits for the Encoder rather than Dropping
+    if (is_recording())
+      capture_frame(surface, true);
+
+    // COUNTER TRACK
+    calc_frames_per_second(start);
+    frame_count++;
+  }
+
+  if (!png_path.empty())
+    surface->write_to_png(png_path);
+  stop_recording();
+
+  // REPORT
+  if (!frame_times.empty()) {
+    double total = 0.0, min_time = frame_times[0], max_time = frame_times[0];
+    for (double t : frame_times) {
+      total += t;
+      min_time = std::min(min_time, t);
+      max_time = std::max(max_time, t);
+    }
+    spdlog::info("Offscreen {}x{}: {} frames, draw mean[{:.3f}ms] min[{:.3f}ms] max[{:.3f}ms], update mean[{:.3f}ms]",
+      width, height, frame_times.size(), total / frame_times.size(), min_time, max_time, update_total / frame_times.size());
+  }
+
+  offscreen = false;
+  return frame_times;
+}
@@ -0,0 +1,63 @@
+#include "DensityImage.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty image and its count to coverage table.
+ */
+DensityImage::DensityImage() {
+  width = height = 0;
+  dirty_top = dirty_bottom = 0;
+
+  for (int count = 0; count < 256; count++)
+    coverage_lut[count] = (uint8_t)std::lround(255.0 * (1.0 - std::exp(-DENSITY_GAIN * count)));
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Starts a frame, resizing the image or clearing the rows counted last time.
+ *
+ * @param width - Width in pixels
+ * @param height - Height in pixels
+ */
+void DensityImage::begin(int width, int height) {
+  if (width != this->width || height != this->height) {
+    this->width = std::max(width, 0);
+    this->height = std::max(height, 0);
+    counts.assign((size_t)this->width * this->height, 0);
+    coverage.assign(this->width, 0);
+  } else if (dirty_top < dirty_bottom) {
+    std::fill(counts.begin() + (size_t)dirty_top * width, counts.begin() + (size_t)dirty_bottom * width, 0);
+  }
+
+  dirty_top = this->height;
+  dirty_bottom = 0;
+}
+
+/**
+ * Blends the color over every counted row of the framebuffer, each pixel's
+ *  coverage rising with its count and saturating at full coverage.
+ *
+ * @param pixels - Framebuffer the same size as the image
+ * @param color - Color of dense areas
+ */
+void DensityImage::resolve(PixelBuffer &pixels, const RgbaColor &color) {
+  for (int y = dirty_top; y < dirty_bottom; y++) {
+    const uint16_t *row = &counts[(size_t)y * width];
+
+    // Only the Stretch between the First and Last Counted Pixel
+    int x0 = 0, x1 = width;
+    while (x0 < x1 && row[x0] == 0) x0++;
+    while (x1 > x0 && row[x1 - 1] == 0) x1--;
+    if (x0 == x1) continue;
+
+    for (int x = x0; x < x1; x++)
+      coverage[x - x0] = coverage_lut[std::min<uint16_t>(row[x], 255)];
+    pixels.span(y, x0, coverage.data(), x1 - x0, color);
+  }
+}
@@ -0,0 +1,235 @@
+#include "DrawList.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty list, drawing opaque black with Cairo's default line
+ *  width and font size until told otherwise.
+ */
+DrawList::DrawList() {
+  current = DrawState{
+    .color = RgbaColor{ .r = 0.0, .g = 0.0, .b = 0.0, .a = 1.0 },
+    .line_width = 2.0,
+    .font_size = 10.0,
+  };
+  state_changed = true;
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @return Index of the current state, adding it if it changed since the last
+ *  recorded command
+ */
+uint32_t DrawList::current_state() {
+  if (state_changed) {
+    states.push_back(current);
+    state_changed = false;
+  }
+  return states.size() - 1;
+}
+
+/**
+ * @return True if both commands can be drawn by the same fill, stroke or
+ *  font selection
+ */
+bool DrawList::same_batch(const Command &a, const Command &b) const {
+  if (a.type != b.type) return false;
+  if (a.state == b.state) return true;
+  return !state_less(a.state, b.state) && !state_less(b.state, a.state);
+}
+
+/**
+ * Orders states by color, then line width, then font size.
+ */
+bool DrawList::state_less(uint32_t a, uint32_t b) const {
+  const DrawState &sa = states[a], &sb = states[b];
+  if (sa.color.r != sb.color.r) return sa.color.r < sb.color.r;
+  if (sa.color.g != sb.color.g) return sa.color.g < sb.color.g;
+  if (sa.color.b != sb.color.b) return sa.color.b < sb.color.b;
+  if (sa.color.a != sb.color.a) return sa.color.a < sb.color.a;
+  if (sa.line_width != sb.line_width) return sa.line_width < sb.line_width;
+  return sa.font_size < sb.font_size;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+void DrawList::set_color(const RgbaColor &color) {
+  if (color.r == current.color.r && color.g == current.color.g &&
+      color.b == current.color.b && color.a == current.color.a) return;
+  current.color = color;
+  state_changed = true;
+}
+
+void DrawList::set_line_width(double width) {
+  if (width == current.line_width) return;
+  current.line_width = width;
+  state_changed = true;
+}
+
+void DrawList::set_font_size(double size) {
+  if (size == current.font_size) return;
+  current.font_size = size;
+  state_changed = true;
+}
+
+/**
+ * Records a circle filled with the current color.
+ *
+ * @param x - x-coordinate of the center
+ * @param y - y-coordinate of the center
+ * @param r - Radius
+ */
+void DrawList::circle(double x, double y, double r) {
+  commands.push_back(Command{
+    .type = FILL_CIRCLE,
+    .state = current_state(),
+    .order = (uint32_t)commands.size(),
+    .text = 0,
+    .a = x, .b = y, .c = r, .d = 0.0,
+  });
+}
+
+/**
+ * Records a line stroked with the current color and width, round capped.
+ *
+ * @param x1 - Start x-coordinate
+ * @param y1 - Start y-coordinate
+ * @param x2 - End x-coordinate
+ * @param y2 - End y-coordinate
+ */
+void DrawList::line(double x1, double y1, double x2, double y2) {
+  commands.push_back(Command{
+    .type = STROKE_LINE,
+    .state = current_state(),
+    .order = (uint32_t)commands.size(),
+    .text = 0,
+    .a = x1, .b = y1, .c = x2, .d = y2,
+  });
+}
+
+/**
+ * Records text in the current color and font size.
+ *
+ * @param x - x-coordinate of the baseline start
+ * @param y - y-coordinate of the baseline start
+ * @param text - Text to draw, copied into the list
+ */
+void DrawList::text(double x, double y, const char *text) {
+  const uint32_t offset = text_data.size();
+  text_data.append(text);
+  text_data.push_back('\0');
+
+  commands.push_back(Command{
+    .type = SHOW_TEXT,
+    .state = current_state(),
+    .order = (uint32_t)commands.size(),
+    .text = offset,
+    .a = x, .b = y, .c = 0.0, .d = 0.0,
+  });
+}
+
+/**
+ * Sorts the recorded commands by kind and state, then draws every run that
+ *  shares a state with a single fill, stroke or font selection. The list is
+ *  empty afterwards and the Cairo context's state is left as it was.
+ *
+ * @param cairo_ctx - Context to draw on
+ * @param sprites - If not NULL, circles it can draw are blitted from it
+ * @param text - If not NULL, text is drawn through it
+ */
+void DrawList::flush(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, SpriteCache *sprites, TextCache *text) {
+  std::sort(commands.begin(), commands.end(), [this](const Command &a, const Command &b) {
+    if (a.type != b.type) return a.type < b.type;
+    if (a.state != b.state) {
+      if (state_less(a.state, b.state)) return true;
+      if (state_less(b.state, a.state)) return false;
+    }
+    return a.order < b.order;
+  });
+
+  cairo_ctx->save();
+  cairo_ctx->begin_new_path();
+  cairo_ctx->set_line_cap(Cairo::LINE_CAP_ROUND);
+  cairo_ctx->select_font_face("Sans", Cairo::FONT_SLANT_NORMAL, Cairo::FONT_WEIGHT_NORMAL);
+
+  size_t begin = 0;
+  while (begin < commands.size()) {
+    const Command &first = commands[begin];
+    const DrawState &state = states[first.state];
+    size_t end = begin + 1;
+    while (end < commands.size() && same_batch(commands[end], first))
+      end++;
+
+    cairo_ctx->set_source_rgba(state.color.r, state.color.g, state.color.b, state.color.a);
+    switch (first.type) {
+      case FILL_CIRCLE: {
+        // Sprites set their own source, so leftover arcs are filled after.
+        bool has_arcs = false;
+        for (size_t k = begin; k < end; k++) {
+          const Command &c = commands[k];
+          if (sprites && sprites->draw_circle(cairo_ctx, c.a, c.b, c.c, state.color)) continue;
+          cairo_ctx->new_sub_path();
+          cairo_ctx->arc(c.a, c.b, c.c, 0, M_PI*2);
+          has_arcs = true;
+        }
+        if (has_arcs) {
+          cairo_ctx->set_source_rgba(state.color.r, state.color.g, state.color.b, state.color.a);
+          cairo_ctx->fill();
+        }
+        break;
+      }
+
+      case STROKE_LINE:
+        cairo_ctx->set_line_width(state.line_width);
+        for (size_t k = begin; k < end; k++) {
+          const Command &c = commands[k];
+          cairo_ctx->move_to(c.a, c.b);
+          cairo_ctx->line_to(c.c, c.d);
+        }
+        cairo_ctx->stroke();
+        break;
+
+      case SHOW_TEXT:
+        if (text) {
+          for (size_t k = begin; k < end; k++) {
+            const Command &c = commands[k];
+            text->draw_text(cairo_ctx, c.a, c.b, &text_data[c.text], state.font_size, state.color);
+          }
+          break;
+        }
+
+        cairo_ctx->set_font_size(state.font_size);
+        for (size_t k = begin; k < end; k++) {
+          const Command &c = commands[k];
+          cairo_ctx->move_to(c.a, c.b);
+          cairo_ctx->show_text(&text_data[c.text]);
+        }
+        cairo_ctx->begin_new_path();
+        break;
+    }
+    begin = end;
+  }
+
+  cairo_ctx->restore();
+  clear();
+}
+
+/**
+ * Drops every recorded command, keeping storage and the current state.
+ */
+void DrawList::clear() {
+  commands.clear();
+  states.clear();
+  text_data.clear();
+  state_changed = true;
+}
+
+size_t DrawList::size() const {
+  return commands.size();
+}
@@ -0,0 +1,229 @@
+#include "ForceKernel.h"
+#include "Physics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define FORCE_KERNEL_X86
+  #include <immintrin.h>
+#endif
+
+
+/* SCALAR KERNEL */
+
+/**
+ * Sums the force contribution of bodies [j, n) on a body at (xi, yi), without
+ *  the G * m_i factor.
+ */
+static inline void direct_sum_tail(
+  const double *x, const double *y, const double *mass, size_t j, size_t n,
+  double xi, double yi, double &acc_x, double &acc_y
+) {
+  for (; j < n; j++) {
+    const double dx = x[j] - xi;
+    const double dy = y[j] - yi;
+    const double r_sq = dx * dx + dy * dy;
+    if (r_sq <= 0.0) continue;
+
+    const double s = mass[j] / (r_sq * std::sqrt(r_sq));
+    acc_x += s * dx;
+    acc_y += s * dy;
+  }
+}
+
+static void direct_sum_scalar(
+  const double *x, const double *y, const double *mass, size_t n,
+  size_t begin, size_t end, double *fx, double *fy
+) {
+  for (size_t i = begin; i < end; i++) {
+    double acc_x = 0.0, acc_y = 0.0;
+    direct_sum_tail(x, y, mass, 0, n, x[i], y[i], acc_x, acc_y);
+
+    const double g_mi = GRAVITATIONAL_CONST * mass[i];
+    fx[i] = g_mi * acc_x;
+    fy[i] = g_mi * acc_y;
+  }
+}
+
+
+#ifdef FORCE_KERNEL_X86
+
+/* SSE2 KERNEL: 2 Bodies per Instruction */
+
+__attribute__((target("sse2")))
+static void direct_sum_sse2(
+  const double *x, const double *y, const double *mass, size_t n,
+  size_t begin, size_t end, double *fx, double *fy
+) {
+  const __m128d zero = _mm_setzero_pd();
+  for (size_t i = begin; i < end; i++) {
+    const __m128d xi = _mm_set1_pd(x[i]);
+    const __m128d yi = _mm_set1_pd(y[i]);
+    __m128d sum_x = zero, sum_y = zero;
+
+    size_t j = 0;
+    for (; j + 2 <= n; j += 2) {
+      const __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + j), xi);
+      const __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + j), yi);
+      const __m128d r_sq = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+      const __m128d r_cubed = _mm_mul_pd(r_sq, _mm_sqrt_pd(r_sq));
+
+      // Coincident Bodies (Self) Contribute Nothing
+      const __m128d s = _mm_and_pd(
+        _mm_div_pd(_mm_loadu_pd(mass + j), r_cubed),
+        _mm_cmpgt_pd(r_sq, zero)
+      );
+      sum_x = _mm_add_pd(sum_x, _mm_mul_pd(s, dx));
+      sum_y = _mm_add_pd(sum_y, _mm_mul_pd(s, dy));
+    }
+
+    double lanes_x[2], lanes_y[2];
+    _mm_storeu_pd(lanes_x, sum_x);
+    _mm_storeu_pd(lanes_y, sum_y);
+    double acc_x = lanes_x[0] + lanes_x[1];
+    double acc_y = lanes_y[0] + lanes_y[1];
+    direct_sum_tail(x, y, mass, j, n, x[i], y[i], acc_x, acc_y);
+
+    const double g_mi = GRAVITATIONAL_CONST * mass[i];
+    fx[i] = g_mi * acc_x;
+    fy[i] = g_mi * acc_y;
+  }
+}
+
+
+/* AVX2 KERNEL: 4 Bodies per Instruction */
+
+__attribute__((target("avx2,fma")))
+static void direct_sum_avx2(
+  const double *x, const double *y, const double *mass, size_t n,
+  size_t begin, size_t end, double *fx, double *fy
+) {
+  const __m256d zero = _mm256_setzero_pd();
+  for (size_t i = begin; i < end; i++) {
+    const __m256d xi = _mm256_set1_pd(x[i]);
+    const __m256d yi = _mm256_set1_pd(y[i]);
+    __m256d sum_x = zero, sum_y = zero;
+
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+      const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), xi);
+      const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), yi);
+      const __m256d r_sq = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+      const __m256d r_cubed = _mm256_mul_pd(r_sq, _mm256_sqrt_pd(r_sq));
+
+      // Coincident Bodies (Self) Contribute Nothing
+      const __m256d s = _mm256_and_pd(
+        _mm256_div_pd(_mm256_loadu_pd(mass + j), r_cubed),
+        _mm256_cmp_pd(r_sq, zero, _CMP_GT_OQ)
+      );
+      sum_x = _mm256_fmadd_pd(s, dx, sum_x);
+      sum_y = _mm256_fmadd_pd(s, dy, sum_y);
+    }
+
+    double lanes_x[4], lanes_y[4];
+    _mm256_storeu_pd(lanes_x, sum_x);
+    _mm256_storeu_pd(lanes_y, sum_y);
+    double acc_x = (lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3]);
+    double acc_y = (lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3]);
+    direct_sum_tail(x, y, mass, j, n, x[i], y[i], acc_x, acc_y);
+
+    const double g_mi = GRAVITATIONAL_CONST * mass[i];
+    fx[i] = g_mi * acc_x;
+    fy[i] = g_mi * acc_y;
+  }
+}
+
+
+/* AVX-512 KERNEL: 8 Bodies per Instruction */
+
+__attribute__((target("avx512f")))
+static void direct_sum_avx512(
+  const double *x, const double *y, const double *mass, size_t n,
+  size_t begin, size_t end, double *fx, double *fy
+) {
+  const __m512d zero = _mm512_setzero_pd();
+  for (size_t i = begin; i < end; i++) {
+    const __m512d xi = _mm512_set1_pd(x[i]);
+    const __m512d yi = _mm512_set1_pd(y[i]);
+    __m512d sum_x = zero, sum_y = zero;
+
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(x + j), xi);
+      const __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(y + j), yi);
+      const __m512d r_sq = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+
+      // Coincident Bodies (Self) Contribute Nothing. Zero-masked forms only,
+      //  GCC 12 warns about the undefined pass-through of the unmasked ones.
+      const __mmask8 apart = _mm512_cmp_pd_mask(r_sq, zero, _CMP_GT_OQ);
+      const __m512d r_cubed = _mm512_mul_pd(r_sq, _mm512_maskz_sqrt_pd(apart, r_sq));
+      const __m512d s = _mm512_maskz_div_pd(apart, _mm512_loadu_pd(mass + j), r_cubed);
+      sum_x = _mm512_fmadd_pd(s, dx, sum_x);
+      sum_y = _mm512_fmadd_pd(s, dy, sum_y);
+    }
+
+    double lanes_x[8], lanes_y[8];
+    _mm512_storeu_pd(lanes_x, sum_x);
+    _mm512_storeu_pd(lanes_y, sum_y);
+    double acc_x = ((lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3])) + ((lanes_x[4] + lanes_x[5]) + (lanes_x[6] + lanes_x[7]));
+    double acc_y = ((lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3])) + ((lanes_y[4] + lanes_y[5]) + (lanes_y[6] + lanes_y[7]));
+    direct_sum_tail(x, y, mass, j, n, x[i], y[i], acc_x, acc_y);
+
+    const double g_mi = GRAVITATIONAL_CONST * mass[i];
+    fx[i] = g_mi * acc_x;
+    fy[i] = g_mi * acc_y;
+  }
+}
+
+#endif // FORCE_KERNEL_X86
+
+
+/* DISPATCH */
+
+/**
+ * Detects the fastest instruction set supported by the running CPU (and OS).
+ *
+ * @return Best supported SIMD_LEVEL
+ */
+SIMD_LEVEL detect_simd_level() {
+#ifdef FORCE_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return SSE2;
+#endif
+  return SCALAR;
+}
+
+/**
+ * @param level - SIMD Level
+ * @return Name of the given level
+ */
+const char *simd_level_name(SIMD_LEVEL level) {
+  switch (level) {
+    case AVX512:  return "AVX-512";
+    case AVX2:    return "AVX2";
+    case SSE2:    return "SSE2";
+    default:      return "Scalar";
+  }
+}
+
+/**
+ * Returns the direct sum kernel for the given level. Levels that were not
+ *  compiled in fall back to the scalar kernel.
+ *
+ * @param level - SIMD Level, must be supported by the running CPU
+ * @return Direct Sum Kernel
+ */
+DirectSumKernel get_direct_sum_kernel(SIMD_LEVEL level) {
+#ifdef FORCE_KERNEL_X86
+  switch (level) {
+    case AVX512:  return direct_sum_avx512;
+    case AVX2:    return direct_sum_avx2;
+    case SSE2:    return direct_sum_sse2;
+    default:      break;
+  }
+#endif
+  return direct_sum_scalar;
+}
@@ -0,0 +1,302 @@
+#include "FrameRecorder.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+/* PIXEL CONVERSION */
+
+/**
+ * Splits a premultiplied ARGB32 pixel into straight-alpha channels.
+ */
+static inline void unpremultiply(uint32_t p, uint32_t &r, uint32_t &g, uint32_t &b, uint32_t &a) {
+  a = p >> 24;
+  r = p >> 16 & 0xFF;
+  g = p >> 8 & 0xFF;
+  b = p & 0xFF;
+  if (a == 255 || a == 0) return;
+  r = (r * 255 + a / 2) / a;
+  g = (g * 255 + a / 2) / a;
+  b = (b * 255 + a / 2) / a;
+}
+
+/**
+ * Converts a frame to straight-alpha RGBA8.
+ */
+static void to_rgba(const uint32_t *pixels, size_t count, uint8_t *out) {
+  for (size_t i = 0; i < count; i++, out += 4) {
+    uint32_t r, g, b, a;
+    unpremultiply(pixels[i], r, g, b, a);
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+    out[3] = a;
+  }
+}
+
+/**
+ * Converts a frame to planar Y, Cb, Cr (BT.601, studio range), one sample
+ *  of each per pixel. Alpha is dropped.
+ */
+static void to_yuv444(const uint32_t *pixels, size_t count, uint8_t *out) {
+  uint8_t *y_plane = out, *u_plane = out + count, *v_plane = out + count * 2;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t r, g, b, a;
+    unpremultiply(pixels[i], r, g, b, a);
+    const int ri = r, gi = g, bi = b;
+    y_plane[i] = ((66 * ri + 129 * gi + 25 * bi + 128) >> 8) + 16;
+    u_plane[i] = ((-38 * ri - 74 * gi + 112 * bi + 128) >> 8) + 128;
+    v_plane[i] = ((112 * ri - 94 * gi - 18 * bi + 128) >> 8) + 128;
+  }
+}
+
+
+/* CONSTRUCTORS / DESTRUCTORS */
+
+FrameRecorder::FrameRecorder() {
+  format = Y4M;
+  width = height = 0;
+  fps = 0.0;
+  out = NULL;
+  recording = false;
+  stopping = false;
+  next_index = 0;
+  written_frames = 0;
+  dropped_frames = 0;
+  write_failed = false;
+}
+
+FrameRecorder::~FrameRecorder() {
+  stop();
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Writes queued frames in order until stopped and drained.
+ */
+void FrameRecorder::encoder_loop() {
+  while (true) {
+    FrameBuffer *frame;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      frame_queued.wait(lock, [this] { return stopping || !queued.empty(); });
+      if (queued.empty()) return;                               // Stopping and Drained
+      frame = queued.front();
+      queued.pop_front();
+    }
+
+    if (!write_failed) {
+      if (write_frame(*frame))
+        written_frames++;
+      else
+        write_failed = true;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      free_buffers.push_back(frame);
+    }
+    buffer_freed.notify_one();
+  }
+}
+
+/**
+ * Converts a frame to the output format and writes it.
+ *
+ * @param frame - Captured frame
+ * @return False on a write error
+ */
+bool FrameRecorder::write_frame(const FrameBuffer &frame) {
+  const size_t count = (size_t)width * height;
+
+  switch (format) {
+    case Y4M:
+      to_yuv444(frame.pixels.data(), count, scratch.data());
+      if (fputs("FRAME\n", out) == EOF) return false;
+      return fwrite(scratch.data(), 1, count * 3, out) == count * 3;
+
+    case RAW_RGBA:
+      to_rgba(frame.pixels.data(), count, scratch.data());
+      return fwrite(scratch.data(), 1, count * 4, out) == count * 4;
+
+    case PNG_SEQUENCE: {
+      char file_name[4096];
+      snprintf(file_name, sizeof(file_name), "%s_%06llu.png", path.c_str(), (unsigned long long)frame.index);
+
+      // Wraps the Buffer, Cairo only Reads it
+      auto surface = Cairo::ImageSurface::create(
+        (unsigned char*)frame.pixels.data(), Cairo::FORMAT_ARGB32, width, height, width * 4
+      );
+      try {
+        surface->write_to_png(file_name);
+      } catch (const std::exception &e) {
+        spdlog::error("Recording: {}", e.what());
+        return false;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Starts recording, opening the output and allocating every buffer up front.
+ *  Any recording in progress is stopped first.
+ *
+ * @param path - Output file, or file name prefix for PNG_SEQUENCE
+ * @param format - Output format
+ * @param width - Width of the recorded frames
+ * @param height - Height of the recorded frames
+ * @param fps - Frame rate stored in Y4M headers
+ * @param buffer_count - Frames that can wait for the encoder
+ * @return False if the output can't be opened
+ */
+bool FrameRecorder::start(const std::string &path, RECORD_FORMAT format, int width, int height, double fps, size_t buffer_count) {
+  stop();
+  if (width <= 0 || height <= 0) return false;
+
+  this->path = path;
+  this->format = format;
+  this->width = width;
+  this->height = height;
+  this->fps = fps > 0.0 ? fps : 60.0;
+
+  // OPEN OUTPUT
+  if (format != PNG_SEQUENCE) {
+    out = fopen(path.c_str(), "wb");
+    if (!out) {
+      spdlog::error("Recording: can't open {}", path);
+      return false;
+    }
+  }
+  if (format == Y4M)
+    fprintf(out, "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C444\n", width, height, std::lround(this->fps * 1000.0));
+
+  // ALLOCATE: Pool and Scratch, never Touched by the Render Thread again
+  const size_t count = (size_t)width * height;
+  buffers.clear();
+  buffers.resize(std::max<size_t>(buffer_count, 1));
+  free_buffers.clear();
+  for (FrameBuffer &buffer : buffers) {
+    buffer.pixels.assign(count, 0);
+    free_buffers.push_back(&buffer);
+  }
+  scratch.resize(format == Y4M ? count * 3 : format == RAW_RGBA ? count * 4 : 0);
+
+  next_index = 0;
+  written_frames = 0;
+  dropped_frames = 0;
+  write_failed = false;
+  stopping = false;
+  recording = true;
+  encoder = std::thread(&FrameRecorder::encoder_loop, this);
+  return true;
+}
+
+/**
+ * Stops recording once every queued frame is written, and frees the pool.
+ */
+void FrameRecorder::stop() {
+  if (!recording) return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  frame_queued.notify_one();
+  encoder.join();
+
+  if (out) {
+    fclose(out);
+    out = NULL;
+  }
+  recording = false;
+  spdlog::info("Recording {}: {} frames written, {} dropped{}",
+    path, get_written_frames(), get_dropped_frames(), write_failed ? ", stopped by a write error" : "");
+
+  buffers.clear();
+  buffers.shrink_to_fit();
+  free_buffers.clear();
+  scratch.clear();
+  scratch.shrink_to_fit();
+}
+
+/**
+ * Copies a rendered frame into a pooled buffer for the encoder.
+ *
+ * @param argb32 - Premultiplied ARGB32 pixels, e.g. an image surface's data
+ * @param width - Width of the frame
+ * @param height - Height of the frame
+ * @param stride - Bytes per row of the frame
+ * @param wait - True to wait for a free buffer, False to drop the frame instead
+ * @return False if not recording or the frame was dropped
+ */
+bool FrameRecorder::capture(const uint8_t *argb32, int width, int height, int stride, bool wait) {
+  if (!recording) return false;
+
+  FrameBuffer *frame;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (free_buffers.empty()) {
+      if (!wait) {
+        dropped_frames++;
+        next_index++;
+        return false;
+      }
+      buffer_freed.wait(lock, [this] { return !free_buffers.empty(); });
+    }
+    frame = free_buffers.back();
+    free_buffers.pop_back();
+  }
+
+  // COPY: Crop or Pad to the Recorded Size
+  const int copy_width = std::min(width, this->width);
+  const int copy_height = std::min(height, this->height);
+  uint32_t *dst = frame->pixels.data();
+  for (int y = 0; y < this->height; y++, dst += this->width) {
+    int copied = 0;
+    if (y < copy_height) {
+      std::memcpy(dst, argb32 + (size_t)y * stride, (size_t)copy_width * 4);
+      copied = copy_width;
+    }
+    std::fill(dst + copied, dst + this->width, 0u);
+  }
+  frame->index = next_index++;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.push_back(frame);
+  }
+  frame_queued.notify_one();
+  return true;
+}
+
+bool FrameRecorder::is_recording() const {
+  return recording;
+}
+
+uint64_t FrameRecorder::get_written_frames() const {
+  return written_frames;
+}
+
+uint64_t FrameRecorder::get_dropped_frames() const {
+  return dropped_frames;
+}
+
+/**
+ * @param path - Output path
+ * @return Y4M for ".y4m", RAW_RGBA for ".rgba" or ".raw", else PNG_SEQUENCE
+ */
+RECORD_FORMAT FrameRecorder::format_for_path(const std::string &path) {
+  const size_t dot = path.rfind('.');
+  const std::string extension = dot == std::string::npos ? "" : path.substr(dot);
+  if (extension == ".y4m") return Y4M;
+  if (extension == ".rgba" || extension == ".raw") return RAW_RGBA;
+  return PNG_SEQUENCE;
+}
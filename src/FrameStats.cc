@@ -0,0 +1,77 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty record.
+ */
+FrameStats::FrameStats() {
+  clear();
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Records a duration, replacing the oldest once the window is full.
+ *
+ * @param ns - Duration in nanoseconds
+ */
+void FrameStats::record(int64_t ns) {
+  if (count == WINDOW)
+    total -= samples[head];
+  else
+    count++;
+
+  samples[head] = ns;
+  total += ns;
+  head = head + 1 == WINDOW ? 0 : head + 1;
+}
+
+/**
+ * Removes all samples.
+ */
+void FrameStats::clear() {
+  head = 0;
+  count = 0;
+  total = 0;
+}
+
+/**
+ * Sorts a copy of the window to read its percentiles, nearest-rank.
+ *
+ * @return Statistics of the window in milliseconds, all 0 if empty
+ */
+FrameStats::Summary FrameStats::summary() const {
+  Summary result{};
+  result.samples = count;
+  if (count == 0) return result;
+
+  std::copy(samples.begin(), samples.begin() + count, sorted.begin());
+  std::sort(sorted.begin(), sorted.begin() + count);
+
+  auto percentile = [&](double p) {
+    size_t rank = (size_t)std::ceil(p * count);
+    rank = std::min(std::max(rank, (size_t)1), count);
+    return sorted[rank - 1] / 1e6;
+  };
+
+  result.min_ms = sorted[0] / 1e6;
+  result.mean_ms = mean_ms();
+  result.p50_ms = percentile(0.50);
+  result.p95_ms = percentile(0.95);
+  result.p99_ms = percentile(0.99);
+  result.max_ms = sorted[count - 1] / 1e6;
+  return result;
+}
+
+double FrameStats::mean_ms() const {
+  return count > 0 ? (double)total / count / 1e6 : 0.0;
+}
+
+size_t FrameStats::size() const {
+  return count;
+}
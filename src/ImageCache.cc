@@ -0,0 +1,142 @@
+#include "ImageCache.h"
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty cache using the best premultiply kernel for this CPU.
+ *
+ * @param budget - Max bytes of surfaces to keep
+ */
+ImageCache::ImageCache(size_t budget) {
+  this->budget = budget;
+  used = 0;
+  premultiply = get_premultiply_kernel(detect_simd_level());
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Evicts least recently drawn surfaces until at most the given bytes are held.
+ *
+ * @param bytes - Bytes to get down to
+ */
+void ImageCache::evict_to(size_t bytes) {
+  while (used > bytes && !lru.empty()) {
+    used -= lru.back().bytes;
+    entries.erase(lru.back().pixbuf.get());
+    lru.pop_back();
+  }
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Surface of a pixbuf, uploading it on a miss. A surface larger than the
+ *  whole budget is returned but not kept.
+ *
+ * @param pixbuf - Image to draw
+ * @return Cached surface of the image, empty if it can't be converted
+ */
+Cairo::RefPtr<Cairo::ImageSurface> ImageCache::get_surface(const Glib::RefPtr<Gdk::Pixbuf> &pixbuf) {
+  // HIT: Move to Front
+  auto found = entries.find(pixbuf.get());
+  if (found != entries.end()) {
+    lru.splice(lru.begin(), lru, found->second);
+    return found->second->surface;
+  }
+
+  // MISS: Upload
+  auto surface = upload(pixbuf, premultiply);
+  if (!surface) return surface;
+
+  const size_t bytes = (size_t)surface->get_stride() * surface->get_height();
+  if (bytes > budget) return surface;
+
+  evict_to(budget - bytes);
+  lru.push_front(Entry{
+    .pixbuf = pixbuf,
+    .surface = surface,
+    .bytes = bytes,
+  });
+  entries[pixbuf.get()] = lru.begin();
+  used += bytes;
+  return surface;
+}
+
+/**
+ * Drops the surface of a pixbuf, so it is uploaded again on next use.
+ *
+ * @param pixbuf - Image whose pixels changed
+ */
+void ImageCache::forget(const Glib::RefPtr<Gdk::Pixbuf> &pixbuf) {
+  auto found = entries.find(pixbuf.get());
+  if (found == entries.end()) return;
+
+  used -= found->second->bytes;
+  lru.erase(found->second);
+  entries.erase(found);
+}
+
+/**
+ * Drops every surface.
+ */
+void ImageCache::clear() {
+  evict_to(0);
+}
+
+void ImageCache::set_budget(size_t bytes) {
+  budget = bytes;
+  evict_to(budget);
+}
+
+size_t ImageCache::get_budget() const {
+  return budget;
+}
+
+size_t ImageCache::get_used_bytes() const {
+  return used;
+}
+
+size_t ImageCache::size() const {
+  return entries.size();
+}
+
+/**
+ * Converts a pixbuf's RGBA8 (or RGB8) rows into a new premultiplied ARGB32
+ *  image surface, row by row.
+ *
+ * @param pixbuf - Image to convert
+ * @param premultiply - Kernel converting RGBA rows
+ * @return New surface, empty if the pixbuf isn't 8 bits per sample
+ */
+Cairo::RefPtr<Cairo::ImageSurface> ImageCache::upload(const Glib::RefPtr<Gdk::Pixbuf> &pixbuf, PremultiplyKernel premultiply) {
+  Cairo::RefPtr<Cairo::ImageSurface> surface;
+  if (!pixbuf || pixbuf->get_bits_per_sample() != 8) return surface;
+
+  const int width = pixbuf->get_width();
+  const int height = pixbuf->get_height();
+  const int channels = pixbuf->get_n_channels();
+  const int src_stride = pixbuf->get_rowstride();
+  const guint8 *src = pixbuf->get_pixels();
+  if (channels != 3 && channels != 4) return surface;
+
+  surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+  surface->flush();
+  unsigned char *dst = surface->get_data();
+  const int dst_stride = surface->get_stride();
+
+  for (int row = 0; row < height; row++) {
+    uint32_t *dst_row = (uint32_t*)(dst + (size_t)row * dst_stride);
+    const uint8_t *src_row = src + (size_t)row * src_stride;
+    if (channels == 4)
+      premultiply(src_row, dst_row, width);
+    else
+      rgb_to_argb32(src_row, dst_row, width);
+  }
+
+  surface->mark_dirty();
+  return surface;
+}
@@ -0,0 +1,174 @@
+#include "ImageLoader.h"
+
+
+/* IMAGE REQUEST */
+
+/**
+ * Creates a pending request.
+ *
+ * @param path - File to decode
+ * @param placeholder - Image to show until decoded, may be empty
+ */
+ImageRequest::ImageRequest(const std::string &path, const Glib::RefPtr<Gdk::Pixbuf> &placeholder) {
+  this->path = path;
+  this->placeholder = placeholder;
+  status = IMAGE_PENDING;
+}
+
+Glib::RefPtr<Gdk::Pixbuf> ImageRequest::get() const {
+  return status == IMAGE_READY ? image : placeholder;
+}
+
+IMAGE_STATUS ImageRequest::get_status() const {
+  return status;
+}
+
+bool ImageRequest::is_ready() const {
+  return status == IMAGE_READY;
+}
+
+const std::string &ImageRequest::get_path() const {
+  return path;
+}
+
+const std::string &ImageRequest::get_error() const {
+  return error;
+}
+
+
+
+/* CONSTRUCTORS / DESTRUCTORS */
+
+/**
+ * Creates a loader. No threads are started until the first load.
+ *
+ * @param thread_count - Decoding threads, at least 1
+ */
+ImageLoader::ImageLoader(size_t thread_count) {
+  this->thread_count = thread_count > 0 ? thread_count : 1;
+  stopping = false;
+  in_flight = 0;
+}
+
+/**
+ * Stops the workers, waiting for decodes already started. Queued files are
+ *  dropped and stay pending.
+ */
+ImageLoader::~ImageLoader() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Decodes queued files until the loader is destroyed. Only the result is
+ *  published here; the request itself is updated by poll on the GTK thread.
+ */
+void ImageLoader::worker_loop() {
+  while (true) {
+    IMAGE_HANDLE request;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (stopping) return;
+
+      request = queue.front();
+      queue.pop_front();
+    }
+
+    Decoded result{ .request = request, .image = Glib::RefPtr<Gdk::Pixbuf>(), .error = "" };
+    try {
+      result.image = Gdk::Pixbuf::create_from_file(request->path);
+    } catch (const Glib::Error &e) {
+      result.error = e.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(decoded_mutex);
+      decoded.push_back(result);
+    }
+    if (on_decoded)
+      on_decoded();
+  }
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Queues an image file for decoding on a worker thread.
+ *
+ * @param path - File to decode
+ * @param placeholder - Image the handle returns until decoding finishes
+ * @return Handle to the image, pending until a later poll
+ */
+IMAGE_HANDLE ImageLoader::load(const std::string &path, const Glib::RefPtr<Gdk::Pixbuf> &placeholder) {
+  IMAGE_HANDLE request = std::make_shared<ImageRequest>(path, placeholder);
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (workers.empty()) {
+      for (size_t i = 0; i < thread_count; i++)
+        workers.emplace_back(&ImageLoader::worker_loop, this);
+    }
+    queue.push_back(request);
+  }
+  wake.notify_one();
+
+  in_flight++;
+  return request;
+}
+
+/**
+ * Hands decoded images to their requests. Must be called from the thread
+ *  that reads the handles. If a worker holds the lock, nothing is delivered
+ *  this time rather than waiting for it.
+ *
+ * @return Number of requests that finished
+ */
+size_t ImageLoader::poll() {
+  {
+    std::unique_lock<std::mutex> lock(decoded_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || decoded.empty()) return 0;
+    delivering.swap(decoded);
+  }
+
+  const size_t count = delivering.size();
+  for (Decoded &result : delivering) {
+    ImageRequest &request = *result.request;
+    request.image = result.image;
+    request.error = result.error;
+    if (result.image) {
+      request.status = IMAGE_READY;
+      request.placeholder.reset();
+    } else {
+      request.status = IMAGE_FAILED;                            // Keeps Showing the Placeholder
+    }
+  }
+  delivering.clear();
+
+  in_flight -= count;
+  return count;
+}
+
+size_t ImageLoader::pending() const {
+  return in_flight;
+}
+
+/**
+ * Sets a function called on a worker thread after each image is decoded.
+ *  Must be set before the first load.
+ *
+ * @param on_decoded - Thread-safe notification, e.g. Glib::Dispatcher::emit
+ */
+void ImageLoader::set_on_decoded(NotifyFn on_decoded) {
+  this->on_decoded = on_decoded;
+}
@@ -0,0 +1,77 @@
+#include "LayerStack.h"
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Adds a layer. It's painted on its first composite.
+ *
+ * @param paint - Paints the layer's content
+ * @return Index of the new layer
+ */
+size_t LayerStack::add(PaintFn paint) {
+  layers.push_back(Layer{
+    .paint = paint,
+    .surface = Cairo::RefPtr<Cairo::Surface>(),
+    .width = 0,
+    .height = 0,
+    .valid = false,
+  });
+  return layers.size() - 1;
+}
+
+void LayerStack::invalidate(size_t layer) {
+  layers[layer].valid = false;
+}
+
+void LayerStack::invalidate_all() {
+  for (Layer &layer : layers)
+    layer.valid = false;
+}
+
+/**
+ * Paints a layer onto the context with a single paint. The layer is painted
+ *  into its surface first if it was invalidated or the size changed; the
+ *  surface is only reallocated when the size changes.
+ *
+ * @param cairo_ctx - Context to composite onto, its target is used to create the surface
+ * @param layer - Index of the layer
+ * @param width - Width of the area
+ * @param height - Height of the area
+ */
+void LayerStack::composite(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, size_t layer, int width, int height) {
+  if (width <= 0 || height <= 0) return;
+  Layer &l = layers[layer];
+
+  // RESIZE: New Surface Similar to the Target
+  if (!l.surface || l.width != width || l.height != height) {
+    l.surface = cairo_ctx->get_target()->create_similar(Cairo::CONTENT_COLOR_ALPHA, width, height);
+    l.width = width;
+    l.height = height;
+    l.valid = false;
+  }
+
+  // RASTERIZE: Clear and Re-Paint
+  if (!l.valid) {
+    auto layer_ctx = Cairo::Context::create(l.surface);
+    layer_ctx->set_operator(Cairo::OPERATOR_CLEAR);
+    layer_ctx->paint();
+    layer_ctx->set_operator(Cairo::OPERATOR_OVER);
+    l.paint(layer_ctx, width, height);
+    l.surface->flush();
+    l.valid = true;
+  }
+
+  cairo_ctx->save();
+  cairo_ctx->set_source(l.surface, 0, 0);
+  cairo_ctx->paint();
+  cairo_ctx->restore();
+}
+
+bool LayerStack::is_valid(size_t layer) const {
+  return layers[layer].valid;
+}
+
+size_t LayerStack::size() const {
+  return layers.size();
+}
@@ -12,7 +12,8 @@ void MyWindow::initProperties() {
   drawArea->show();
 
   // SETUP EVENTS
-  Gtk::Window::add_events(Gdk::KEY_PRESS_MASK | Gdk::KEY_RELEASE_MASK | Gdk::BUTTON_PRESS_MASK);
+  Gtk::Window::add_events(Gdk::KEY_PRESS_MASK | Gdk::KEY_RELEASE_MASK | Gdk::BUTTON_PRESS_MASK
+    | Gdk::POINTER_MOTION_MASK | Gdk::SCROLL_MASK);
 }
 
 
@@ -68,17 +69,39 @@ MyWindow::~MyWindow() {
 /* KEYBOARD EVENT CALLBACKS */
 
 bool MyWindow::on_key_press_event(GdkEventKey *event) {
-  if(!drawArea->on_key_press(event)) this->destroy_();
+  if(!drawArea->on_key_press(event)) {
+    this->destroy_();
+    return true;
+  }
+  drawArea->request_redraw();     // Wakes On-Demand Drawing
   return true;
 }
 
 bool MyWindow::on_key_release_event(GdkEventKey *event) {
-  if(!drawArea->on_key_release(event)) this->destroy_();
+  if(!drawArea->on_key_release(event)) {
+    this->destroy_();
+    return true;
+  }
+  drawArea->request_redraw();
   return true;
 }
 
 /* MOUSE EVENT CALLBACKS */
 bool MyWindow::on_button_press_event(GdkEventButton *event) {
-  if(!drawArea->on_mouse_press(event)) this->destroy_();
-	return true;
+  if(!drawArea->on_mouse_press(event)) {
+    this->destroy_();
+    return true;
+  }
+  drawArea->request_redraw();
+  return true;
+}
+
+bool MyWindow::on_motion_notify_event(GdkEventMotion*) {
+  drawArea->request_redraw();     // Pointer Moved, Wake On-Demand Drawing
+  return false;
+}
+
+bool MyWindow::on_scroll_event(GdkEventScroll*) {
+  drawArea->request_redraw();
+  return false;
 }
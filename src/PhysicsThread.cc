@@ -0,0 +1,143 @@
+#include "PhysicsThread.h"
+
+
+/* CONSTRUCTORS / DESTRUCTORS */
+
+/**
+ * Creates a stopped physics thread for the given simulation.
+ *
+ * @param simulation - Simulation to advance, must outlive this object
+ * @param tick_rate - Steps per second
+ */
+PhysicsThread::PhysicsThread(Simulation &simulation, double tick_rate) : simulation(simulation) {
+  tick_interval = std::chrono::nanoseconds((long long)(1e9 / tick_rate));
+  running = false;
+  dropped_ticks = 0;
+}
+
+/**
+ * Stops the thread if still running.
+ */
+PhysicsThread::~PhysicsThread() {
+  stop();
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Runs every command posted since the last tick, outside of the lock.
+ */
+void PhysicsThread::apply_commands() {
+  {
+    std::lock_guard<std::mutex> lock(command_mutex);
+    pending.swap(commands);
+  }
+
+  for (Command &command : pending)
+    command(simulation);
+  pending.clear();
+}
+
+/**
+ * Steps the simulation once per tick and publishes the result. When a step
+ *  takes longer than MAX_LAG_TICKS ticks to catch up on, the missed ticks are
+ *  dropped instead of bursting through them.
+ */
+void PhysicsThread::run() {
+  auto next_tick = std::chrono::steady_clock::now() + tick_interval;
+
+  while (running) {
+    tick();
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - next_tick > tick_interval * MAX_LAG_TICKS) {
+      dropped_ticks += (now - next_tick) / tick_interval;
+      next_tick = now;
+    } else {
+      std::this_thread::sleep_until(next_tick);
+    }
+    next_tick += tick_interval;
+  }
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Publishes the current state, so the first frame has something to draw,
+ *  then starts ticking.
+ */
+void PhysicsThread::start() {
+  if (running) return;
+
+  simulation.snapshot(snapshots.write_buffer());
+  snapshots.publish();
+
+  running = true;
+  thread = std::thread(&PhysicsThread::run, this);
+}
+
+/**
+ * Stops ticking and waits for the current step to finish.
+ */
+void PhysicsThread::stop() {
+  running = false;
+  if (thread.joinable())
+    thread.join();
+}
+
+/**
+ * Queues a command to run on the physics thread before the next step. Use
+ *  this for every change to the simulation once started.
+ *
+ * @param command - Function called with the simulation
+ */
+void PhysicsThread::post(Command command) {
+  std::lock_guard<std::mutex> lock(command_mutex);
+  commands.push_back(std::move(command));
+}
+
+/**
+ * Applies posted commands, steps the simulation and publishes the result on
+ *  the calling thread. Drives the simulation directly while the thread is
+ *  not running, e.g. one step per frame when rendering offscreen.
+ */
+void PhysicsThread::tick() {
+  apply_commands();
+
+  auto start = std::chrono::steady_clock::now();
+  simulation.step();
+  auto end = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    step_times.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  }
+
+  simulation.snapshot(snapshots.write_buffer());
+  snapshots.publish();
+}
+
+/**
+ * @return Newest published state of the simulation
+ */
+const SimulationSnapshot &PhysicsThread::latest_snapshot() {
+  snapshots.update();
+  return snapshots.read_buffer();
+}
+
+double PhysicsThread::get_tick_rate() const {
+  return 1e9 / tick_interval.count();
+}
+
+uint64_t PhysicsThread::get_dropped_ticks() const {
+  return dropped_ticks;
+}
+
+/**
+ * @return Statistics of the most recent step durations, safe from any thread
+ */
+FrameStats::Summary PhysicsThread::get_step_stats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex);
+  return step_times.summary();
+}
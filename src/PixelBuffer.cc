@@ -0,0 +1,310 @@
+#include "PixelBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+  #define PIXEL_BUFFER_SSE
+  #include <emmintrin.h>
+#endif
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty buffer, sized by the first begin.
+ */
+PixelBuffer::PixelBuffer() {
+  pixels = NULL;
+  width = height = 0;
+  stride = 0;
+  dirty_top = dirty_bottom = 0;
+
+  const SIMD_LEVEL level = detect_simd_level();
+  blend_over = get_blend_span_kernel(level, BLEND_OVER);
+  blend_add = get_blend_span_kernel(level, BLEND_ADD);
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+BlendSpanKernel PixelBuffer::get_blend(BLEND_MODE mode) const {
+  return mode == BLEND_ADD ? blend_add : blend_over;
+}
+
+void PixelBuffer::touch_rows(int top, int bottom) {
+  if (top >= bottom) return;
+  if (dirty_top >= dirty_bottom) {
+    dirty_top = top;
+    dirty_bottom = bottom;
+    return;
+  }
+  dirty_top = std::min(dirty_top, top);
+  dirty_bottom = std::max(dirty_bottom, bottom);
+}
+
+/**
+ * Blends one row of an anti-aliased disc. Coverage falls off linearly over
+ *  the pixel straddling the edge.
+ *
+ * @param y - Row
+ * @param x - x-coordinate of the disc center
+ * @param dy - Distance from the disc center to the row's pixel centers
+ * @param r - Radius
+ * @param color - Premultiplied color
+ * @param blend - Span kernel
+ */
+void PixelBuffer::disc_span(int y, double x, double dy, double r, uint32_t color, BlendSpanKernel blend) {
+  const double outer = r + 0.5;
+  const double half_width2 = outer * outer - dy * dy;
+  if (half_width2 <= 0.0) return;
+
+  const double half_width = std::sqrt(half_width2);
+  const int x0 = std::max(0, (int)std::floor(x - half_width));
+  const int x1 = std::min(width, (int)std::ceil(x + half_width));
+  if (x0 >= x1) return;
+
+  // COVERAGE: clamp(r + 0.5 - distance, 0, 1), 4 Pixels at once. Float and
+  //  + 0.5 then truncate in both paths, so every pixel of a disc rounds alike.
+  const int count = x1 - x0;
+  uint8_t *cov = coverage.data();
+  const float dx0 = (float)(x0 + 0.5 - x);
+  const float dy2 = (float)(dy * dy);
+  const float edge = (float)outer;
+  int i = 0;
+#ifdef PIXEL_BUFFER_SSE
+  const __m128 dy2_4 = _mm_set1_ps(dy2);
+  const __m128 edge_4 = _mm_set1_ps(edge);
+  const __m128 dx0_4 = _mm_set1_ps(dx0);
+  const __m128 scale = _mm_set1_ps(255.f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 step = _mm_set1_ps(4.f);
+  __m128 index = _mm_set_ps(3.f, 2.f, 1.f, 0.f);                // Whole Floats, so Stepping is Exact
+  for (; i + 4 <= count; i += 4, index = _mm_add_ps(index, step)) {
+    const __m128 dx = _mm_add_ps(dx0_4, index);
+    const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2_4));
+    __m128 c = _mm_sub_ps(edge_4, distance);
+    c = _mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    __m128i bytes = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), half));
+    bytes = _mm_packus_epi16(_mm_packs_epi32(bytes, bytes), bytes);
+    const uint32_t packed = _mm_cvtsi128_si32(bytes);
+    std::copy((const uint8_t*)&packed, (const uint8_t*)&packed + 4, cov + i);
+  }
+#endif
+  for (; i < count; i++) {
+    const float dx = dx0 + (float)i;
+    const float c = std::min(std::max(edge - std::sqrt(dx * dx + dy2), 0.f), 1.f);
+    cov[i] = (uint8_t)(c * 255.f + 0.5f);
+  }
+
+  blend(pixels + (size_t)y * stride + x0, cov, count, color);
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Starts a frame: recreates the buffer if the size changed, otherwise clears
+ *  the rows written since the last frame to transparent.
+ *
+ * @param width - Width of the area
+ * @param height - Height of the area
+ */
+void PixelBuffer::begin(int width, int height) {
+  if (width <= 0 || height <= 0) return;
+
+  if (!surface || this->width != width || this->height != height) {
+    surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+    pixels = (uint32_t*)surface->get_data();
+    stride = surface->get_stride() / 4;
+    this->width = width;
+    this->height = height;
+    coverage.assign(width, 0);
+    dirty_top = dirty_bottom = 0;
+    return;
+  }
+
+  surface->flush();
+  for (int y = dirty_top; y < dirty_bottom; y++)
+    std::fill_n(pixels + (size_t)y * stride, width, 0u);
+  dirty_top = dirty_bottom = 0;
+}
+
+/**
+ * Paints the buffer over the context.
+ *
+ * @param cairo_ctx - Context to draw on
+ */
+void PixelBuffer::composite(const Cairo::RefPtr<Cairo::Context> &cairo_ctx) {
+  if (!surface) return;
+
+  surface->mark_dirty();
+  cairo_ctx->save();
+  cairo_ctx->set_source(surface, 0, 0);
+  cairo_ctx->paint();
+  cairo_ctx->restore();
+}
+
+/**
+ * Sets every pixel to the color, replacing what was there.
+ *
+ * @param color - Fill color
+ */
+void PixelBuffer::clear(const RgbaColor &color) {
+  const uint32_t argb = to_argb32(color);
+  for (int y = 0; y < height; y++)
+    std::fill_n(pixels + (size_t)y * stride, width, argb);
+  dirty_top = 0;
+  dirty_bottom = argb ? height : 0;                             // Transparent is already Clear
+}
+
+/**
+ * Blends a color over a rectangle, clipped to the buffer.
+ *
+ * @param x - Left of the rectangle
+ * @param y - Top of the rectangle
+ * @param width - Width of the rectangle
+ * @param height - Height of the rectangle
+ * @param color - Fill color
+ * @param mode - Blend mode
+ */
+void PixelBuffer::fill_rect(int x, int y, int width, int height, const RgbaColor &color, BLEND_MODE mode) {
+  const int x0 = std::max(x, 0), x1 = std::min(x + width, this->width);
+  const int y0 = std::max(y, 0), y1 = std::min(y + height, this->height);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  const uint32_t argb = to_argb32(color);
+  const BlendSpanKernel blend = get_blend(mode);
+  std::fill_n(coverage.begin(), x1 - x0, 255);
+  for (int row = y0; row < y1; row++)
+    blend(pixels + (size_t)row * stride + x0, coverage.data(), x1 - x0, argb);
+  touch_rows(y0, y1);
+}
+
+/**
+ * Blends a single pixel at the given position.
+ */
+void PixelBuffer::point(double x, double y, const RgbaColor &color, BLEND_MODE mode) {
+  points(&x, &y, 1, color, mode);
+}
+
+/**
+ * Blends one pixel per position, all in the same color. Positions outside
+ *  the buffer are skipped.
+ *
+ * @param x - x-coordinates
+ * @param y - y-coordinates
+ * @param count - Number of points
+ * @param color - Point color
+ * @param mode - Blend mode
+ */
+void PixelBuffer::points(const double *x, const double *y, size_t count, const RgbaColor &color, BLEND_MODE mode) {
+  const uint32_t argb = to_argb32(color);
+  const BlendSpanKernel blend = get_blend(mode);
+  const uint8_t full = 255;
+  int top = height, bottom = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!(x[i] >= 0.0 && x[i] < width && y[i] >= 0.0 && y[i] < height)) continue;
+    const int px = (int)x[i], py = (int)y[i];
+    blend(pixels + (size_t)py * stride + px, &full, 1, argb);
+    top = std::min(top, py);
+    bottom = std::max(bottom, py + 1);
+  }
+  touch_rows(top, bottom);
+}
+
+/**
+ * Blends an anti-aliased disc, clipped to the buffer.
+ *
+ * @param x - x-coordinate of the center
+ * @param y - y-coordinate of the center
+ * @param r - Radius
+ * @param color - Fill color
+ * @param mode - Blend mode
+ */
+void PixelBuffer::disc(double x, double y, double r, const RgbaColor &color, BLEND_MODE mode) {
+  discs(&x, &y, &r, 1, color, mode);
+}
+
+/**
+ * Blends anti-aliased discs, all in the same color, one span per row.
+ *
+ * @param x - x-coordinates of the centers
+ * @param y - y-coordinates of the centers
+ * @param r - Radii
+ * @param count - Number of discs
+ * @param color - Fill color
+ * @param mode - Blend mode
+ */
+void PixelBuffer::discs(const double *x, const double *y, const double *r, size_t count, const RgbaColor &color, BLEND_MODE mode) {
+  const uint32_t argb = to_argb32(color);
+  const BlendSpanKernel blend = get_blend(mode);
+  int top = height, bottom = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!(r[i] > 0.0)) continue;
+    const double outer = r[i] + 0.5;
+    const int y0 = std::max(0, (int)std::floor(y[i] - outer));
+    const int y1 = std::min(height, (int)std::ceil(y[i] + outer));
+    if (y0 >= y1 || x[i] + outer < 0.0 || x[i] - outer > width) continue;
+
+    for (int row = y0; row < y1; row++)
+      disc_span(row, x[i], row + 0.5 - y[i], r[i], argb, blend);
+    top = std::min(top, y0);
+    bottom = std::max(bottom, y1);
+  }
+  touch_rows(top, bottom);
+}
+
+/**
+ * Blends a color over part of a row, scaled by each pixel's coverage, for
+ *  shapes rasterized elsewhere. Clipped to the buffer.
+ *
+ * @param y - Row
+ * @param x - First pixel
+ * @param coverage - Coverage of each pixel, 255 = fully covered
+ * @param count - Number of pixels
+ * @param color - Color
+ * @param mode - Blend mode
+ */
+void PixelBuffer::span(int y, int x, const uint8_t *coverage, int count, const RgbaColor &color, BLEND_MODE mode) {
+  if (y < 0 || y >= height) return;
+  if (x < 0) {
+    coverage -= x;
+    count += x;
+    x = 0;
+  }
+  count = std::min(count, width - x);
+  if (count <= 0) return;
+
+  get_blend(mode)(pixels + (size_t)y * stride + x, coverage, count, to_argb32(color));
+  touch_rows(y, y + 1);
+}
+
+uint32_t *PixelBuffer::get_row(int y) {
+  return pixels + (size_t)y * stride;
+}
+
+void PixelBuffer::mark_rows(int top, int bottom) {
+  touch_rows(std::max(top, 0), std::min(bottom, height));
+}
+
+int PixelBuffer::get_width() const {
+  return width;
+}
+
+int PixelBuffer::get_height() const {
+  return height;
+}
+
+/**
+ * @param color - Straight-alpha color, channels in [0, 1]
+ * @return Color as a premultiplied ARGB32 pixel
+ */
+uint32_t PixelBuffer::to_argb32(const RgbaColor &color) {
+  const double a = std::min(std::max(color.a, 0.0), 1.0);
+  auto channel = [a](double c) {
+    return channel_8(std::min(std::max(c, 0.0), 1.0) * a);
+  };
+  return channel_8(a) << 24 | channel(color.r) << 16 | channel(color.g) << 8 | channel(color.b);
+}
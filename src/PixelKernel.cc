@@ -0,0 +1,283 @@
+#include "PixelKernel.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define PIXEL_KERNEL_X86
+  #include <immintrin.h>
+#endif
+
+
+/* SCALAR KERNEL */
+
+/**
+ * @return round(c * a / 255) without a division
+ */
+static inline uint32_t mul_div_255(uint32_t c, uint32_t a) {
+  const uint32_t t = c * a + 128;
+  return (t + (t >> 8)) >> 8;
+}
+
+static void premultiply_scalar(const uint8_t *src, uint32_t *dst, size_t count) {
+  for (size_t i = 0; i < count; i++, src += 4) {
+    const uint32_t a = src[3];
+    dst[i] = a << 24 | mul_div_255(src[0], a) << 16 | mul_div_255(src[1], a) << 8 | mul_div_255(src[2], a);
+  }
+}
+
+static void fade_scalar(uint32_t *pixels, size_t count, uint32_t factor) {
+  for (size_t i = 0; i < count; i++) {
+    const uint32_t p = pixels[i];
+    if (p == 0) continue;
+    pixels[i] = ((p >> 24) * factor >> 8) << 24 | ((p >> 16 & 0xFF) * factor >> 8) << 16 |
+                ((p >> 8 & 0xFF) * factor >> 8) << 8 | ((p & 0xFF) * factor >> 8);
+  }
+}
+
+/**
+ * @return Color with every channel scaled by coverage / 255
+ */
+static inline uint32_t scale_color(uint32_t color, uint32_t coverage) {
+  return mul_div_255(color >> 24, coverage) << 24 | mul_div_255(color >> 16 & 0xFF, coverage) << 16 |
+         mul_div_255(color >> 8 & 0xFF, coverage) << 8 | mul_div_255(color & 0xFF, coverage);
+}
+
+static void blend_over_scalar(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color) {
+  for (size_t i = 0; i < count; i++) {
+    if (coverage[i] == 0) continue;
+    const uint32_t src = coverage[i] == 255 ? color : scale_color(color, coverage[i]);
+    dst[i] = src + scale_color(dst[i], 255 - (src >> 24));
+  }
+}
+
+static void blend_add_scalar(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color) {
+  for (size_t i = 0; i < count; i++) {
+    if (coverage[i] == 0) continue;
+    const uint32_t src = coverage[i] == 255 ? color : scale_color(color, coverage[i]);
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+      out |= std::min<uint32_t>((src >> shift & 0xFF) + (dst[i] >> shift & 0xFF), 255) << shift;
+    dst[i] = out;
+  }
+}
+
+
+#ifdef PIXEL_KERNEL_X86
+
+/* SSE2 KERNEL: 4 Pixels per Instruction */
+
+/**
+ * Premultiplies two RGBA pixels widened to 16 bits per channel and swaps
+ *  them to BGRA, the byte order of little-endian ARGB32. Alpha is multiplied
+ *  by 255, leaving it unchanged.
+ */
+__attribute__((target("sse2")))
+static inline __m128i premultiply_sse2_16(__m128i v) {
+  const __m128i rgb_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+  const __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+  __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+  a = _mm_or_si128(_mm_and_si128(a, rgb_mask), alpha_one);
+
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(v, a), _mm_set1_epi16(128));
+  t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(t, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+__attribute__((target("sse2")))
+static void premultiply_sse2(const uint8_t *src, uint32_t *dst, size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i px = _mm_loadu_si128((const __m128i*)(src + i * 4));
+    const __m128i lo = premultiply_sse2_16(_mm_unpacklo_epi8(px, zero));
+    const __m128i hi = premultiply_sse2_16(_mm_unpackhi_epi8(px, zero));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+  }
+  premultiply_scalar(src + i * 4, dst + i, count - i);
+}
+
+/**
+ * Fades 4 pixels at a time, widening each byte to 16 bits so c * 256 fits.
+ */
+__attribute__((target("sse2")))
+static void fade_sse2(uint32_t *pixels, size_t count, uint32_t factor) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i f = _mm_set1_epi16((short)factor);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i px = _mm_loadu_si128((const __m128i*)(pixels + i));
+    const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), f), 8);
+    const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), f), 8);
+    _mm_storeu_si128((__m128i*)(pixels + i), _mm_packus_epi16(lo, hi));
+  }
+  fade_scalar(pixels + i, count - i, factor);
+}
+
+/**
+ * @return round(x * y / 255) for 16-bit lanes holding 8-bit values
+ */
+__attribute__((target("sse2")))
+static inline __m128i mul_div_255_sse2(__m128i x, __m128i y) {
+  const __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/**
+ * Loads 4 coverage bytes and widens them to 16 bits, repeated across each
+ *  pixel's 4 channels: lo holds pixels 0 and 1, hi pixels 2 and 3.
+ */
+__attribute__((target("sse2")))
+static inline void load_coverage_sse2(const uint8_t *coverage, __m128i &lo, __m128i &hi) {
+  uint32_t bytes;
+  std::copy(coverage, coverage + 4, (uint8_t*)&bytes);
+  __m128i c = _mm_cvtsi32_si128((int)bytes);
+  c = _mm_unpacklo_epi8(c, c);                                  // c0 c0 c1 c1 c2 c2 c3 c3
+  c = _mm_unpacklo_epi16(c, c);                                 // c0 x4, c1 x4, c2 x4, c3 x4
+  const __m128i zero = _mm_setzero_si128();
+  lo = _mm_unpacklo_epi8(c, zero);
+  hi = _mm_unpackhi_epi8(c, zero);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i over_sse2_16(__m128i dst, __m128i color, __m128i cov) {
+  const __m128i src = mul_div_255_sse2(color, cov);
+  const __m128i src_a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xFF), 0xFF);
+  return _mm_add_epi16(src, mul_div_255_sse2(dst, _mm_sub_epi16(_mm_set1_epi16(255), src_a)));
+}
+
+__attribute__((target("sse2")))
+static void blend_over_sse2(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i cov_lo, cov_hi;
+    load_coverage_sse2(coverage + i, cov_lo, cov_hi);
+    const __m128i px = _mm_loadu_si128((const __m128i*)(dst + i));
+    const __m128i lo = over_sse2_16(_mm_unpacklo_epi8(px, zero), color16, cov_lo);
+    const __m128i hi = over_sse2_16(_mm_unpackhi_epi8(px, zero), color16, cov_hi);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+  }
+  blend_over_scalar(dst + i, coverage + i, count - i, color);
+}
+
+__attribute__((target("sse2")))
+static void blend_add_sse2(uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t color) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i cov_lo, cov_hi;
+    load_coverage_sse2(coverage + i, cov_lo, cov_hi);
+    const __m128i src = _mm_packus_epi16(mul_div_255_sse2(color16, cov_lo), mul_div_255_sse2(color16, cov_hi));
+    const __m128i px = _mm_loadu_si128((const __m128i*)(dst + i));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(px, src));
+  }
+  blend_add_scalar(dst + i, coverage + i, count - i, color);
+}
+
+
+/* AVX2 KERNEL: 8 Pixels per Instruction */
+
+__attribute__((target("avx2")))
+static inline __m256i premultiply_avx2_16(__m256i v) {
+  const __m256i rgb_mask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+  const __m256i alpha_one = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+
+  __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xFF), 0xFF);
+  a = _mm256_or_si256(_mm256_and_si256(a, rgb_mask), alpha_one);
+
+  __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(v, a), _mm256_set1_epi16(128));
+  t = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+  return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(t, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+__attribute__((target("avx2")))
+static void premultiply_avx2(const uint8_t *src, uint32_t *dst, size_t count) {
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    // Unpack and Pack both Work within 128-bit Lanes, so Pixel Order is Kept.
+    const __m256i px = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+    const __m256i lo = premultiply_avx2_16(_mm256_unpacklo_epi8(px, zero));
+    const __m256i hi = premultiply_avx2_16(_mm256_unpackhi_epi8(px, zero));
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(lo, hi));
+  }
+  premultiply_sse2(src + i * 4, dst + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void fade_avx2(uint32_t *pixels, size_t count, uint32_t factor) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i f = _mm256_set1_epi16((short)factor);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i px = _mm256_loadu_si256((const __m256i*)(pixels + i));
+    const __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(px, zero), f), 8);
+    const __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(px, zero), f), 8);
+    _mm256_storeu_si256((__m256i*)(pixels + i), _mm256_packus_epi16(lo, hi));
+  }
+  fade_sse2(pixels + i, count - i, factor);
+}
+
+#endif
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * @param level - SIMD Level, AVX-512 uses the AVX2 kernel
+ * @return Premultiply kernel for the given level
+ */
+PremultiplyKernel get_premultiply_kernel(SIMD_LEVEL level) {
+#ifdef PIXEL_KERNEL_X86
+  switch (level) {
+    case AVX512:
+    case AVX2:    return premultiply_avx2;
+    case SSE2:    return premultiply_sse2;
+    default:      break;
+  }
+#endif
+  return premultiply_scalar;
+}
+
+/**
+ * @param level - SIMD Level, AVX-512 uses the AVX2 kernel
+ * @return Fade kernel for the given level
+ */
+FadeKernel get_fade_kernel(SIMD_LEVEL level) {
+#ifdef PIXEL_KERNEL_X86
+  switch (level) {
+    case AVX512:
+    case AVX2:    return fade_avx2;
+    case SSE2:    return fade_sse2;
+    default:      break;
+  }
+#endif
+  return fade_scalar;
+}
+
+/**
+ * @param level - SIMD Level, spans are short so AVX2 and up use the SSE2 kernels
+ * @param mode - How the color combines with the pixels
+ * @return Blend span kernel for the given level and mode
+ */
+BlendSpanKernel get_blend_span_kernel(SIMD_LEVEL level, BLEND_MODE mode) {
+#ifdef PIXEL_KERNEL_X86
+  if (level != SCALAR)
+    return mode == BLEND_ADD ? blend_add_sse2 : blend_over_sse2;
+#endif
+  return mode == BLEND_ADD ? blend_add_scalar : blend_over_scalar;
+}
+
+/**
+ * Converts opaque RGB8 pixels to ARGB32, no premultiplication needed.
+ *
+ * @param src - RGB8 pixels
+ * @param dst - ARGB32 pixels
+ * @param count - Number of pixels
+ */
+void rgb_to_argb32(const uint8_t *src, uint32_t *dst, size_t count) {
+  for (size_t i = 0; i < count; i++, src += 3)
+    dst[i] = 0xFF000000u | (uint32_t)src[0] << 16 | (uint32_t)src[1] << 8 | src[2];
+}
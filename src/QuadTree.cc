@@ -0,0 +1,222 @@
+#include "QuadTree.h"
+#include <algorithm>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty QuadTree. build() must be called before querying.
+ */
+QuadTree::QuadTree() {
+  x = y = mass = nullptr;
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Splits the given node into four quadrants if it holds too many bodies,
+ *  then accumulates its mass and center of mass.
+ *
+ * @param node_index - Index of the node to build
+ * @param depth - Current depth in the tree
+ */
+void QuadTree::build_node(uint32_t node_index, uint32_t depth) {
+  const Node node = nodes[node_index];
+  const uint32_t count = node.end - node.begin;
+
+  // LEAF: Accumulate Directly
+  if (count <= LEAF_CAPACITY || depth >= MAX_DEPTH) {
+    double m = 0.0, mx = 0.0, my = 0.0;
+    for (uint32_t k = node.begin; k < node.end; k++) {
+      const uint32_t b = order[k];
+      m += mass[b];
+      mx += mass[b] * x[b];
+      my += mass[b] * y[b];
+    }
+
+    Node &leaf = nodes[node_index];
+    leaf.mass = m;
+    leaf.com_x = m > 0.0 ? mx / m : node.cx;
+    leaf.com_y = m > 0.0 ? my / m : node.cy;
+    return;
+  }
+
+  // PARTITION: Bottom/Top, then Left/Right of each half
+  auto first = order.begin() + node.begin;
+  auto last = order.begin() + node.end;
+  auto mid_y = std::partition(first, last, [&](uint32_t b) { return y[b] < node.cy; });
+  auto mid_x0 = std::partition(first, mid_y, [&](uint32_t b) { return x[b] < node.cx; });
+  auto mid_x1 = std::partition(mid_y, last, [&](uint32_t b) { return x[b] < node.cx; });
+
+  const uint32_t bounds[5] = {
+    node.begin,
+    (uint32_t)(mid_x0 - order.begin()),
+    (uint32_t)(mid_y - order.begin()),
+    (uint32_t)(mid_x1 - order.begin()),
+    node.end,
+  };
+
+  // CREATE CHILDREN: Contiguous Block of 4
+  const uint32_t first_child = nodes.size();
+  const double quarter = node.half / 2.0;
+  for (int q = 0; q < 4; q++) {
+    nodes.push_back(Node{
+      .cx = node.cx + ((q & 1) ? quarter : -quarter),
+      .cy = node.cy + ((q & 2) ? quarter : -quarter),
+      .half = quarter,
+      .com_x = 0.0,
+      .com_y = 0.0,
+      .mass = 0.0,
+      .first_child = 0,
+      .begin = bounds[q],
+      .end = bounds[q + 1],
+    });
+  }
+  nodes[node_index].first_child = first_child;
+
+  // RECURSE + ACCUMULATE
+  double m = 0.0, mx = 0.0, my = 0.0;
+  for (uint32_t q = 0; q < 4; q++) {
+    const uint32_t child_index = first_child + q;
+    if (nodes[child_index].begin == nodes[child_index].end) continue;
+    build_node(child_index, depth + 1);
+
+    const Node &child = nodes[child_index];
+    m += child.mass;
+    mx += child.mass * child.com_x;
+    my += child.mass * child.com_y;
+  }
+
+  Node &parent = nodes[node_index];
+  parent.mass = m;
+  parent.com_x = m > 0.0 ? mx / m : node.cx;
+  parent.com_y = m > 0.0 ? my / m : node.cy;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Rebuilds the tree over the given body arrays. Node and index storage is
+ *  reused between builds so steady-state rebuilds do not allocate.
+ *
+ * @param x - Body x-coordinates
+ * @param y - Body y-coordinates
+ * @param mass - Body masses
+ * @param count - Number of bodies
+ */
+void QuadTree::build(const double *x, const double *y, const double *mass, size_t count) {
+  this->x = x;
+  this->y = y;
+  this->mass = mass;
+
+  nodes.clear();
+  order.resize(count);
+  for (size_t i = 0; i < count; i++)
+    order[i] = i;
+
+  if (count == 0) return;
+
+  // ROOT: Bounding Square of all Bodies
+  double min_x = x[0], max_x = x[0];
+  double min_y = y[0], max_y = y[0];
+  for (size_t i = 1; i < count; i++) {
+    min_x = std::min(min_x, x[i]);
+    max_x = std::max(max_x, x[i]);
+    min_y = std::min(min_y, y[i]);
+    max_y = std::max(max_y, y[i]);
+  }
+
+  // Slightly Padded so Bodies on the Max Edge fall Inside
+  const double half = std::max(max_x - min_x, max_y - min_y) / 2.0 * 1.0001 + 1e-9;
+  nodes.push_back(Node{
+    .cx = (min_x + max_x) / 2.0,
+    .cy = (min_y + max_y) / 2.0,
+    .half = half,
+    .com_x = 0.0,
+    .com_y = 0.0,
+    .mass = 0.0,
+    .first_child = 0,
+    .begin = 0,
+    .end = (uint32_t)count,
+  });
+
+  build_node(0, 0);
+}
+
+/**
+ * Calculates the net gravitational force exerted on body i by every other
+ *  body in the tree. Cells containing body i are always opened.
+ *
+ * @param i - Index of the body
+ * @param theta - Opening angle, 0 being exact
+ * @return Net force on body i
+ */
+Vector2D QuadTree::force_on_body(size_t i, double theta) const {
+  Vector2D force{ 0.0, 0.0 };
+  if (nodes.empty()) return force;
+
+  const double xi = x[i], yi = y[i];
+  const double mi = mass[i];
+  const double theta_sq = theta * theta;
+
+  uint32_t stack[4 * MAX_DEPTH + 4];
+  int top = 0;
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const Node &node = nodes[stack[--top]];
+    if (node.begin == node.end) continue;
+
+    // Distance from Body to Cell Box (0 if Inside)
+    const double box_dx = std::max(std::abs(xi - node.cx) - node.half, 0.0);
+    const double box_dy = std::max(std::abs(yi - node.cy) - node.half, 0.0);
+    const double box_d_sq = box_dx * box_dx + box_dy * box_dy;
+
+    // Far Away Cell: Approximate as one Point Mass
+    const double dx = node.com_x - xi;
+    const double dy = node.com_y - yi;
+    const double d_sq = dx * dx + dy * dy;
+    const double size = node.half * 2.0;
+    if (box_d_sq > 0.0 && size * size < theta_sq * d_sq) {
+      const double inv_d = 1.0 / std::sqrt(d_sq);
+      const double f_mag = GRAVITATIONAL_CONST * (mi * node.mass) / d_sq;
+      force.x += f_mag * dx * inv_d;
+      force.y += f_mag * dy * inv_d;
+      continue;
+    }
+
+    // Internal Cell: Open it
+    if (node.first_child != 0) {
+      for (uint32_t q = 0; q < 4; q++)
+        stack[top++] = node.first_child + q;
+      continue;
+    }
+
+    // Leaf Cell: Exact Sum
+    for (uint32_t k = node.begin; k < node.end; k++) {
+      const uint32_t j = order[k];
+      if (j == i) continue;
+
+      const double bdx = x[j] - xi;
+      const double bdy = y[j] - yi;
+      const double r_sq = bdx * bdx + bdy * bdy;
+      if (r_sq <= 0.0) continue;
+
+      const double r = std::sqrt(r_sq);
+      const double f_mag = GRAVITATIONAL_CONST * (mi * mass[j]) / r_sq;
+      force.x += f_mag * bdx / r;
+      force.y += f_mag * bdy / r;
+    }
+  }
+
+  return force;
+}
+
+/**
+ * @return Number of nodes in the tree
+ */
+size_t QuadTree::node_count() const {
+  return nodes.size();
+}
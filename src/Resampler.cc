@@ -0,0 +1,264 @@
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+  #define RESAMPLER_SSE
+  #include <emmintrin.h>
+#endif
+
+// Rows per parallel_for Chunk
+static const size_t ROW_GRAIN = 8;
+
+
+/* FILTER TAPS */
+
+/**
+ * Weights of every output pixel along one axis. Output pixel i is the sum
+ *  of source pixels [start[i], start[i] + count[i]) times weights[i * taps + k].
+ */
+struct FilterTaps {
+  int                 taps;                                     // Max Weights per Output Pixel
+  std::vector<int>    start;
+  std::vector<int>    count;
+  std::vector<float>  weights;
+};
+
+static double filter_support(RESAMPLE_FILTER filter) {
+  return filter == LANCZOS ? 3.0 : 1.0;
+}
+
+/**
+ * @param filter - Bilinear (triangle) or Lanczos-3
+ * @param x - Distance from the center in source pixels
+ * @return Filter weight at x
+ */
+static double filter_kernel(RESAMPLE_FILTER filter, double x) {
+  x = std::abs(x);
+  if (filter != LANCZOS)
+    return std::max(0.0, 1.0 - x);
+
+  if (x < 1e-8) return 1.0;
+  if (x >= 3.0) return 0.0;
+  const double px = M_PI * x;
+  return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+}
+
+/**
+ * Computes normalized filter weights for scaling src_size pixels to dst_size.
+ *  When downscaling, the filter is stretched by the scale factor so it
+ *  averages every source pixel instead of skipping some.
+ */
+static FilterTaps compute_taps(int src_size, int dst_size, RESAMPLE_FILTER filter) {
+  const double scale = (double)dst_size / src_size;
+  const double stretch = scale < 1.0 ? 1.0 / scale : 1.0;
+  const double support = filter_support(filter) * stretch;
+
+  FilterTaps result;
+  result.taps = (int)std::ceil(support) * 2 + 1;
+  result.start.resize(dst_size);
+  result.count.resize(dst_size);
+  result.weights.assign((size_t)dst_size * result.taps, 0.f);
+
+  for (int i = 0; i < dst_size; i++) {
+    // Pixel Centers sit at +0.5
+    const double center = (i + 0.5) / scale;
+    const int first = std::max(0, (int)std::ceil(center - support - 0.5));
+    const int last = std::min(src_size - 1, std::min((int)std::floor(center + support - 0.5), first + result.taps - 1));
+
+    float *weights = &result.weights[(size_t)i * result.taps];
+    double sum = 0.0;
+    for (int j = first; j <= last; j++) {
+      const double w = filter_kernel(filter, (j + 0.5 - center) / stretch);
+      weights[j - first] = w;
+      sum += w;
+    }
+
+    result.start[i] = first;
+    result.count[i] = last - first + 1;
+    if (sum != 0.0) {
+      for (int k = 0; k <= last - first; k++)
+        weights[k] /= sum;
+    } else {
+      // Falls between Filter Lobes: Take the Nearest Pixel
+      result.start[i] = std::min(std::max((int)center, 0), src_size - 1);
+      result.count[i] = 1;
+      std::fill(weights, weights + result.taps, 0.f);
+      weights[0] = 1.f;
+    }
+  }
+  return result;
+}
+
+
+/* PIXEL CONVERSION */
+
+/**
+ * Widens a row to premultiplied float RGBA, 4 floats per pixel.
+ */
+static void load_row(const uint8_t *row, int width, int channels, float *out) {
+  for (int x = 0; x < width; x++, row += channels, out += 4) {
+    const float a = channels == 4 ? row[3] : 255.f;
+    const float f = a / 255.f;
+    out[0] = row[0] * f;
+    out[1] = row[1] * f;
+    out[2] = row[2] * f;
+    out[3] = a;
+  }
+}
+
+/**
+ * Narrows a row of premultiplied float RGBA back to 8-bit straight alpha,
+ *  clamping the overshoot Lanczos can produce.
+ */
+static void store_row(const float *row, int width, int channels, uint8_t *out) {
+  for (int x = 0; x < width; x++, row += 4, out += channels) {
+    const float a = std::min(std::max(row[3], 0.f), 255.f);
+    const float f = a > 0.f ? 255.f / a : 0.f;
+
+#ifdef RESAMPLER_SSE
+    // Scale Colors (not Alpha), Clamp, Round and Narrow all 4 Channels at once.
+    //  Rounds half up like the scalar path: + 0.5 then truncate.
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(row), _mm_set_ps(1.f, f, f, f));
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.f));
+    __m128i i = _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+    i = _mm_packus_epi16(_mm_packs_epi32(i, i), i);
+    const uint32_t rgba = _mm_cvtsi128_si32(i);
+    std::memcpy(out, &rgba, channels);
+#else
+    for (int c = 0; c < 3; c++)
+      out[c] = (uint8_t)(std::min(std::max(row[c] * f, 0.f), 255.f) + 0.5f);
+    if (channels == 4)
+      out[3] = (uint8_t)(a + 0.5f);
+#endif
+  }
+}
+
+
+/* PASSES */
+
+/**
+ * Runs fn over [0, count) rows, on the pool if there is one.
+ */
+static void for_rows(ThreadPool *pool, size_t count, const ThreadPool::RangeFn &fn) {
+  if (pool)
+    pool->parallel_for(count, ROW_GRAIN, fn);
+  else
+    fn(0, count, 0);
+}
+
+/**
+ * Filters one row of premultiplied pixels horizontally.
+ */
+static void filter_row(const float *in, const FilterTaps &taps, int dst_width, float *out) {
+  for (int x = 0; x < dst_width; x++) {
+    const float *weights = &taps.weights[(size_t)x * taps.taps];
+    const float *px = in + (size_t)taps.start[x] * 4;
+    const int count = taps.count[x];
+
+#ifdef RESAMPLER_SSE
+    __m128 acc = _mm_setzero_ps();
+    for (int k = 0; k < count; k++)
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(px + k * 4)));
+    _mm_storeu_ps(out + (size_t)x * 4, acc);
+#else
+    float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+    for (int k = 0; k < count; k++)
+      for (int c = 0; c < 4; c++)
+        acc[c] += weights[k] * px[k * 4 + c];
+    std::copy(acc, acc + 4, out + (size_t)x * 4);
+#endif
+  }
+}
+
+/**
+ * Adds weight times a row of floats onto the accumulator row.
+ */
+static void accumulate_row(const float *in, float weight, size_t count, float *acc) {
+  size_t i = 0;
+#ifdef RESAMPLER_SSE
+  const __m128 w = _mm_set1_ps(weight);
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(w, _mm_loadu_ps(in + i))));
+#endif
+  for (; i < count; i++)
+    acc[i] += weight * in[i];
+}
+
+/**
+ * Copies the nearest source pixel into every destination pixel.
+ */
+static void resample_nearest(const PixelRows &src, const PixelRows &dst, ThreadPool *pool) {
+  std::vector<int> src_x(dst.width);
+  for (int x = 0; x < dst.width; x++)
+    src_x[x] = std::min((int)((x + 0.5) * src.width / dst.width), src.width - 1) * src.channels;
+
+  for_rows(pool, dst.height, [&](size_t begin, size_t end, size_t) {
+    for (size_t y = begin; y < end; y++) {
+      const int sy = std::min((int)((y + 0.5) * src.height / dst.height), src.height - 1);
+      const uint8_t *in = src.pixels + (size_t)sy * src.stride;
+      uint8_t *out = dst.pixels + y * dst.stride;
+      for (int x = 0; x < dst.width; x++, out += dst.channels)
+        std::copy(in + src_x[x], in + src_x[x] + dst.channels, out);
+    }
+  });
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+void resample_image(const PixelRows &src, const PixelRows &dst, RESAMPLE_FILTER filter, ThreadPool *pool) {
+  if (src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) return;
+
+  if (filter == NEAREST) {
+    resample_nearest(src, dst, pool);
+    return;
+  }
+
+  const FilterTaps taps_x = compute_taps(src.width, dst.width, filter);
+  const FilterTaps taps_y = compute_taps(src.height, dst.height, filter);
+  const size_t workers = pool ? pool->get_thread_count() : 1;
+  const size_t dst_row_floats = (size_t)dst.width * 4;
+
+  // HORIZONTAL: Every Source Row to Destination Width
+  std::vector<float> horizontal((size_t)src.height * dst_row_floats);
+  std::vector<std::vector<float>> scratch(workers);
+
+  for_rows(pool, src.height, [&](size_t begin, size_t end, size_t worker) {
+    std::vector<float> &row = scratch[worker];
+    row.resize((size_t)src.width * 4);
+    for (size_t y = begin; y < end; y++) {
+      load_row(src.pixels + y * src.stride, src.width, src.channels, row.data());
+      filter_row(row.data(), taps_x, dst.width, &horizontal[y * dst_row_floats]);
+    }
+  });
+
+  // VERTICAL: Columns to Destination Height
+  for_rows(pool, dst.height, [&](size_t begin, size_t end, size_t worker) {
+    std::vector<float> &acc = scratch[worker];
+    acc.resize(dst_row_floats);
+    for (size_t y = begin; y < end; y++) {
+      std::fill(acc.begin(), acc.end(), 0.f);
+      const float *weights = &taps_y.weights[y * taps_y.taps];
+      for (int k = 0; k < taps_y.count[y]; k++) {
+        if (weights[k] == 0.f) continue;
+        accumulate_row(&horizontal[(size_t)(taps_y.start[y] + k) * dst_row_floats], weights[k], dst_row_floats, acc.data());
+      }
+      store_row(acc.data(), dst.width, dst.channels, dst.pixels + y * dst.stride);
+    }
+  });
+}
+
+/**
+ * @param filter - Resampling filter
+ * @return Name of the given filter
+ */
+const char *resample_filter_name(RESAMPLE_FILTER filter) {
+  switch (filter) {
+    case LANCZOS:   return "Lanczos";
+    case BILINEAR:  return "Bilinear";
+    default:        return "Nearest";
+  }
+}
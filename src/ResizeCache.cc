@@ -0,0 +1,124 @@
+#include "ResizeCache.h"
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty cache.
+ *
+ * @param budget - Max bytes of resized pixels to keep
+ * @param thread_count - Resampling threads including the caller, at least 1
+ */
+ResizeCache::ResizeCache(size_t budget, size_t thread_count) {
+  this->budget = budget;
+  this->thread_count = thread_count > 0 ? thread_count : 1;
+  used = 0;
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Evicts least recently used results until at most the given bytes are held.
+ *
+ * @param bytes - Bytes to get down to
+ */
+void ResizeCache::evict_to(size_t bytes) {
+  while (used > bytes && !lru.empty()) {
+    Entry &oldest = lru.back();
+    used -= oldest.bytes;
+    entries.erase(oldest.key);
+    if (on_evict)
+      on_evict(oldest.resized);
+    lru.pop_back();
+  }
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Resizes an image, reusing an earlier result for the same image, size and
+ *  filter. A result larger than the whole budget is returned but not kept.
+ *
+ * @param image - Image to resize
+ * @param width - Target width
+ * @param height - Target height
+ * @param filter - Resampling filter
+ * @return Resized image, empty if the image or size is invalid
+ */
+Glib::RefPtr<Gdk::Pixbuf> ResizeCache::resize(const Glib::RefPtr<Gdk::Pixbuf> &image, int width, int height, RESAMPLE_FILTER filter) {
+  Glib::RefPtr<Gdk::Pixbuf> resized;
+  if (!image || width <= 0 || height <= 0 || image->get_bits_per_sample() != 8) return resized;
+
+  // HIT: Move to Front
+  const Key key{ .image = image.get(), .width = width, .height = height, .filter = filter };
+  auto found = entries.find(key);
+  if (found != entries.end()) {
+    lru.splice(lru.begin(), lru, found->second);
+    return found->second->resized;
+  }
+
+  // MISS: Resample
+  if (!thread_pool)
+    thread_pool.reset(new ThreadPool(thread_count));
+
+  resized = Gdk::Pixbuf::create(Gdk::COLORSPACE_RGB, image->get_has_alpha(), 8, width, height);
+  const PixelRows src{
+    .pixels = image->get_pixels(),
+    .width = image->get_width(),
+    .height = image->get_height(),
+    .stride = image->get_rowstride(),
+    .channels = image->get_n_channels(),
+  };
+  const PixelRows dst{
+    .pixels = resized->get_pixels(),
+    .width = width,
+    .height = height,
+    .stride = resized->get_rowstride(),
+    .channels = resized->get_n_channels(),
+  };
+  resample_image(src, dst, filter, thread_pool.get());
+
+  const size_t bytes = (size_t)resized->get_rowstride() * height;
+  if (bytes > budget) return resized;
+
+  evict_to(budget - bytes);
+  lru.push_front(Entry{
+    .key = key,
+    .source = image,
+    .resized = resized,
+    .bytes = bytes,
+  });
+  entries[key] = lru.begin();
+  used += bytes;
+  return resized;
+}
+
+void ResizeCache::set_budget(size_t bytes) {
+  budget = bytes;
+  evict_to(budget);
+}
+
+void ResizeCache::set_on_evict(EvictFn on_evict) {
+  this->on_evict = on_evict;
+}
+
+/**
+ * Drops every cached result.
+ */
+void ResizeCache::clear() {
+  evict_to(0);
+}
+
+size_t ResizeCache::get_budget() const {
+  return budget;
+}
+
+size_t ResizeCache::get_used_bytes() const {
+  return used;
+}
+
+size_t ResizeCache::size() const {
+  return entries.size();
+}
@@ -0,0 +1,314 @@
+#include "Simulation.h"
+#include <algorithm>
+
+
+/* PHYSICS HELPERS */
+
+/**
+ * Velocity of body1 after transfering energy with body2.
+ */
+static Vector2D transfer_energy(const Vector2D &v1, double m1, const Vector2D &v2, double m2) {
+  // Conservation of momentum!
+  double total_mass = m1 + m2;
+
+  return {
+    ( 2.f * m2 * v2.x + (m1 - m2) * v1.x) / total_mass,
+    ( 2.f * m2 * v2.y + (m1 - m2) * v1.y) / total_mass,
+  };
+}
+
+/**
+ * Nudges p1 a unit step away from p2.
+ */
+static void unlodge_bodies(Vector2D *p1, const Vector2D &p2) {
+  double d = std::sqrt(std::pow(p2.x - p1->x, 2) + std::pow(p2.y - p1->y, 2));
+  if (d <= 0.f) return;
+
+  p1->x -= (p2.x - p1->x) / d;
+  p1->y -= (p2.y - p1->y) / d;
+}
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty simulation using the direct sum solver.
+ *
+ * @param max_trail_size - Number of past positions kept per body
+ */
+Simulation::Simulation(size_t max_trail_size) : trails(max_trail_size) {
+  step_count = 0;
+  force_mode = FORCE_MODE::DIRECT_SUM;
+  theta = 0.5;
+  set_simd_level(detect_simd_level());
+  set_thread_count(0);
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Calculates the exact net force on every body with the direct sum kernel.
+ *
+ * @param fx - Stores the x-component of each body's net force
+ * @param fy - Stores the y-component of each body's net force
+ */
+void Simulation::direct_sum_forces(double *fx, double *fy) const {
+  const size_t n = bodies.size();
+  thread_pool->parallel_for(n, SOLVE_GRAIN, [&](size_t begin, size_t end, size_t) {
+    direct_sum_kernel(bodies.x.data(), bodies.y.data(), bodies.mass.data(), n, begin, end, fx, fy);
+  });
+}
+
+/**
+ * Rebuilds the Barnes-Hut tree over the current state of the bodies.
+ */
+void Simulation::build_quad_tree() {
+  quad_tree.build(bodies.x.data(), bodies.y.data(), bodies.mass.data(), bodies.size());
+}
+
+/**
+ * Pushes the current position of body i onto its trail.
+ *
+ * @param i - Index of the body
+ */
+void Simulation::record_trail(size_t i) {
+  trails.push(i, { bodies.x[i], bodies.y[i] });
+}
+
+/**
+ * Records trails, calculates forces and resolves collisions for bodies
+ *  [begin, end) into the scratch buffers. Only reads the state at the start
+ *  of the step, so any partition of the bodies gives the same result.
+ *
+ * @param begin - First body
+ * @param end - One past the last body
+ * @param contacts - Worker's scratch buffer for colliding bodies
+ */
+void Simulation::solve_bodies(size_t begin, size_t end, std::vector<size_t> &contacts) {
+  if (force_mode == DIRECT_SUM) {
+    const size_t n = bodies.size();
+    direct_sum_kernel(bodies.x.data(), bodies.y.data(), bodies.mass.data(), n, begin, end, force_x.data(), force_y.data());
+  }
+
+  for (size_t i = begin; i < end; i++) {
+    record_trail(i);
+
+    if (force_mode == BARNES_HUT) {
+      Vector2D force = quad_tree.force_on_body(i, theta);
+      force_x[i] = force.x;
+      force_y[i] = force.y;
+    }
+
+    // Only bodies in neighbouring grid cells can collide. Sorted, so they
+    //  are resolved in the same order as a full pairwise scan would.
+    contacts.clear();
+    collision_grid.find_contacts(i, contacts);
+    std::sort(contacts.begin(), contacts.end());
+
+    // Resolve collisions against the other bodies' starting state.
+    Vector2D pos{ bodies.x[i], bodies.y[i] };
+    Vector2D vel{ bodies.vx[i], bodies.vy[i] };
+    for (size_t j : contacts) {
+      vel = transfer_energy(vel, bodies.mass[i], { bodies.vx[j], bodies.vy[j] }, bodies.mass[j]);
+      unlodge_bodies(&pos, { bodies.x[j], bodies.y[j] });
+    }
+    next_x[i] = pos.x;
+    next_y[i] = pos.y;
+    next_vx[i] = vel.x;
+    next_vy[i] = vel.y;
+  }
+}
+
+/**
+ * Integrates bodies [begin, end) from the scratch buffers.
+ *
+ * @param begin - First body
+ * @param end - One past the last body
+ */
+void Simulation::integrate_bodies(size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    // Update acceleration from the net force.
+    const double ax = bodies.ax[i] + force_x[i] / bodies.mass[i];
+    const double ay = bodies.ay[i] + force_y[i] / bodies.mass[i];
+
+    // Update velocity and displacement.
+    bodies.vx[i] = next_vx[i] + ax;
+    bodies.vy[i] = next_vy[i] + ay;
+    bodies.x[i] = next_x[i] + bodies.vx[i];
+    bodies.y[i] = next_y[i] + bodies.vy[i];
+
+    // Reset acceleration.
+    bodies.ax[i] = 0.f;
+    bodies.ay[i] = 0.f;
+  }
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Adds a body to the simulation.
+ *
+ * @param pos - Initial position
+ * @param mass - Body mass
+ * @param radius - Body radius
+ * @param velocity - Initial velocity
+ * @param acceleration - Initial acceleration, applied on the first step
+ * @return Index of the new body
+ */
+size_t Simulation::add_body(Vector2D pos, double mass, double radius, Vector2D velocity, Vector2D acceleration) {
+  trails.add();
+  force_x.push_back(0.f);
+  force_y.push_back(0.f);
+  return bodies.add(pos, mass, radius, velocity, acceleration);
+}
+
+/**
+ * Advances the simulation by one step, split across the thread pool.
+ */
+void Simulation::step() {
+  const size_t n = bodies.size();
+  next_x.resize(n);
+  next_y.resize(n);
+  next_vx.resize(n);
+  next_vy.resize(n);
+
+  // The tree and grid are built once, then only read while solving.
+  if (force_mode == BARNES_HUT)
+    build_quad_tree();
+  collision_grid.build(bodies.x.data(), bodies.y.data(), bodies.radius.data(), n);
+
+  thread_pool->parallel_for(n, SOLVE_GRAIN, [&](size_t begin, size_t end, size_t worker) {
+    solve_bodies(begin, end, worker_contacts[worker]);
+  });
+
+  thread_pool->parallel_for(n, INTEGRATE_GRAIN, [&](size_t begin, size_t end, size_t) {
+    integrate_bodies(begin, end);
+  });
+
+  step_count++;
+}
+
+/**
+ * Copies the state needed for drawing, reusing the snapshot's storage where
+ *  it can. Every step pushes one point per trail, so trails are only copied
+ *  whole the first time; after that the snapshot's own trails get just the
+ *  points pushed since its step.
+ *
+ * @param snapshot - Snapshot to overwrite, previously filled by this simulation
+ */
+void Simulation::snapshot(SimulationSnapshot &snapshot) const {
+  snapshot.bodies = bodies;
+  snapshot.force_x = force_x;
+  snapshot.force_y = force_y;
+
+  // SNAPSHOT FROM THE FUTURE: Not Ours, Copy Everything
+  const uint64_t behind = snapshot.step_count <= step_count ? step_count - snapshot.step_count : UINT64_MAX;
+  snapshot.trails.catch_up(trails, behind);
+  snapshot.step_count = step_count;
+}
+
+/**
+ * Compares the Barnes-Hut forces against the direct sum for the current
+ *  state of the bodies, without advancing the simulation.
+ *
+ * @param rms_error - Stores the RMS relative error of the net forces
+ * @param max_error - Stores the largest relative error of the net forces
+ */
+void Simulation::measure_force_error(double &rms_error, double &max_error) {
+  build_quad_tree();
+
+  // Exact forces go into the scratch buffers, the last step's forces are kept.
+  next_x.resize(bodies.size());
+  next_y.resize(bodies.size());
+  direct_sum_forces(next_x.data(), next_y.data());
+
+  double sum_sq_error = 0.f;
+  size_t samples = 0;
+  max_error = 0.f;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    Vector2D approx = quad_tree.force_on_body(i, theta);
+    Vector2D exact{ next_x[i], next_y[i] };
+
+    double exact_mag = std::hypot(exact.x, exact.y);
+    if (exact_mag <= 0.f) continue;
+
+    double error = std::hypot(approx.x - exact.x, approx.y - exact.y) / exact_mag;
+    max_error = std::max(max_error, error);
+    sum_sq_error += error * error;
+    samples++;
+  }
+
+  rms_error = samples ? std::sqrt(sum_sq_error / samples) : 0.f;
+}
+
+
+/* GETTERS / SETTERS */
+
+BodyStore &Simulation::get_bodies() {
+  return bodies;
+}
+
+const BodyStore &Simulation::get_bodies() const {
+  return bodies;
+}
+
+const TrailPool &Simulation::get_trails() const {
+  return trails;
+}
+
+Vector2D Simulation::get_net_force(size_t i) const {
+  return { force_x[i], force_y[i] };
+}
+
+uint64_t Simulation::get_step_count() const {
+  return step_count;
+}
+
+FORCE_MODE Simulation::get_force_mode() const {
+  return force_mode;
+}
+
+void Simulation::set_force_mode(FORCE_MODE mode) {
+  force_mode = mode;
+}
+
+double Simulation::get_theta() const {
+  return theta;
+}
+
+void Simulation::set_theta(double theta) {
+  this->theta = theta;
+}
+
+SIMD_LEVEL Simulation::get_simd_level() const {
+  return simd_level;
+}
+
+/**
+ * Selects the direct sum kernel. Levels above what the CPU supports are
+ *  clamped down to the best supported one.
+ *
+ * @param level - Requested SIMD Level
+ */
+void Simulation::set_simd_level(SIMD_LEVEL level) {
+  simd_level = std::min(level, detect_simd_level());
+  direct_sum_kernel = get_direct_sum_kernel(simd_level);
+}
+
+size_t Simulation::get_thread_count() const {
+  return thread_pool->get_thread_count();
+}
+
+/**
+ * Restarts the thread pool with the given number of threads. Results do not
+ *  depend on the thread count.
+ *
+ * @param thread_count - Number of threads, 0 for the hardware concurrency
+ */
+void Simulation::set_thread_count(size_t thread_count) {
+  thread_pool.reset();
+  thread_pool = std::make_unique<ThreadPool>(thread_count);
+  worker_contacts.assign(thread_pool->get_thread_count(), std::vector<size_t>());
+}
@@ -0,0 +1,132 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty grid. build() must be called before querying.
+ */
+SpatialGrid::SpatialGrid() {
+  cell_size = inv_cell_size = 1.0;
+  bucket_mask = 0;
+  x = y = radius = nullptr;
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * @param v - World coordinate
+ * @return Cell coordinate, clamped so far away or non-finite bodies stay valid
+ */
+int64_t SpatialGrid::cell_coord(double v) const {
+  const double LIMIT = 1e15;
+  double c = std::floor(v * inv_cell_size);
+  if (!(c > -LIMIT)) c = -LIMIT;
+  if (!(c < LIMIT)) c = LIMIT;
+  return (int64_t)c;
+}
+
+/**
+ * @param cx - Cell x-coordinate
+ * @param cy - Cell y-coordinate
+ * @return Bucket the cell hashes into
+ */
+size_t SpatialGrid::bucket_of(int64_t cx, int64_t cy) const {
+  const uint64_t h = ((uint64_t)cx * 73856093ull) ^ ((uint64_t)cy * 19349663ull);
+  return (h ^ (h >> 29)) & bucket_mask;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Rebuilds the grid over the given body arrays in O(n). Storage is reused
+ *  between builds.
+ *
+ * @param x - Body x-coordinates
+ * @param y - Body y-coordinates
+ * @param radius - Body radii
+ * @param count - Number of bodies
+ */
+void SpatialGrid::build(const double *x, const double *y, const double *radius, size_t count) {
+  this->x = x;
+  this->y = y;
+  this->radius = radius;
+
+  // CELL SIZE: Largest Diameter
+  double max_radius = 0.0;
+  for (size_t i = 0; i < count; i++)
+    max_radius = std::max(max_radius, radius[i]);
+  cell_size = max_radius > 0.0 ? max_radius * 2.0 : 1.0;
+  inv_cell_size = 1.0 / cell_size;
+
+  // TABLE: Power of 2, ~2 Buckets per Body
+  size_t table_size = 16;
+  while (table_size < count * 2)
+    table_size <<= 1;
+  bucket_mask = table_size - 1;
+
+  // COUNTING SORT: Bodies by Bucket
+  bucket_start.assign(table_size + 1, 0);
+  body_bucket.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    body_bucket[i] = bucket_of(cell_coord(x[i]), cell_coord(y[i]));
+    bucket_start[body_bucket[i] + 1]++;
+  }
+
+  for (size_t b = 0; b < table_size; b++)
+    bucket_start[b + 1] += bucket_start[b];
+
+  sorted.resize(count);
+  for (size_t i = 0; i < count; i++)
+    sorted[bucket_start[body_bucket[i]]++] = i;
+
+  // Placing shifted every start to the next bucket's, shift back.
+  for (size_t b = table_size; b > 0; b--)
+    bucket_start[b] = bucket_start[b - 1];
+  bucket_start[0] = 0;
+}
+
+/**
+ * Finds every body overlapping body i by checking the 3x3 cells around it.
+ *
+ * @param i - Index of the body
+ * @param contacts - Indices of bodies colliding with body i are appended here
+ */
+void SpatialGrid::find_contacts(size_t i, std::vector<size_t> &contacts) const {
+  if (bucket_mask == 0) return;
+
+  const double xi = x[i], yi = y[i], ri = radius[i];
+  const int64_t cx = cell_coord(xi);
+  const int64_t cy = cell_coord(yi);
+
+  // Neighbouring cells may hash to the same bucket, only visit each once.
+  size_t visited[9];
+  int visited_count = 0;
+
+  for (int64_t dy = -1; dy <= 1; dy++) {
+    for (int64_t dx = -1; dx <= 1; dx++) {
+      const size_t bucket = bucket_of(cx + dx, cy + dy);
+      if (std::find(visited, visited + visited_count, bucket) != visited + visited_count) continue;
+      visited[visited_count++] = bucket;
+
+      for (uint32_t k = bucket_start[bucket]; k < bucket_start[bucket + 1]; k++) {
+        const uint32_t j = sorted[k];
+        if (j == i) continue;
+
+        const double bdx = x[j] - xi;
+        const double bdy = y[j] - yi;
+        const double reach = ri + radius[j];
+        if (reach * reach > bdx * bdx + bdy * bdy)
+          contacts.push_back(j);
+      }
+    }
+  }
+}
+
+double SpatialGrid::get_cell_size() const {
+  return cell_size;
+}
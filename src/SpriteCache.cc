@@ -0,0 +1,106 @@
+#include "SpriteCache.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Finds the sprite for a circle, rasterizing it on first use.
+ *
+ * @param radius_steps - Radius in RADIUS_STEPs
+ * @param color - Fill color
+ * @param scale - Device pixels per user unit of the target surface
+ * @return Cached sprite
+ */
+const SpriteCache::Sprite &SpriteCache::get_sprite(uint32_t radius_steps, const RgbaColor &color, double scale) {
+  const uint32_t rgba = to_rgba8(color);
+  const uint64_t scale_quarters = (uint64_t)std::lround(scale * 4.0);
+  const uint64_t key = scale_quarters << 48 | (uint64_t)radius_steps << 32 | rgba;
+
+  // HIT: Move to Front
+  auto found = sprites.find(key);
+  if (found != sprites.end()) {
+    lru.splice(lru.begin(), lru, found->second.lru_slot);
+    return found->second;
+  }
+
+  // FULL: Drop the Least Recently Drawn
+  if (sprites.size() >= MAX_SPRITES) {
+    sprites.erase(lru.back());
+    lru.pop_back();
+  }
+
+  // RASTERIZE: In Device Pixels, 1px Padding around the Circle for Anti-Aliasing
+  const double r = radius_steps * RADIUS_STEP * scale;
+  const int size = (int)std::ceil(r * 2.0) + 2;
+  const double center = size / 2.0;
+
+  lru.push_front(key);
+  Sprite sprite{
+    .surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, size, size),
+    .center = center / scale,
+    .size = size / scale,
+    .lru_slot = lru.begin(),
+  };
+  auto sprite_ctx = Cairo::Context::create(sprite.surface);
+  sprite_ctx->set_source_rgba(color.r, color.g, color.b, color.a);
+  sprite_ctx->arc(center, center, r, 0, M_PI*2);
+  sprite_ctx->fill();
+  sprite.surface->flush();
+  sprite.surface->set_device_scale(scale, scale);
+
+  return sprites.emplace(key, sprite).first->second;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Draws a filled circle by blitting its cached sprite, placed on the nearest
+ *  whole device pixel. Sprites are drawn for the target's device scale, so
+ *  HiDPI surfaces get full resolution circles rather than upscaled ones.
+ *
+ * @param cairo_ctx - Context to draw on
+ * @param x - x-coordinate of the center
+ * @param y - y-coordinate of the center
+ * @param r - Radius
+ * @param color - Fill color
+ * @return False if nothing was drawn: the circle is too large, the context
+ *  transform is more than a translation or the device scale isn't uniform
+ */
+bool SpriteCache::draw_circle(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, double x, double y, double r, const RgbaColor &color) {
+  if (!(r > 0.0) || r > MAX_RADIUS) return false;
+
+  Cairo::Matrix matrix;
+  cairo_ctx->get_matrix(matrix);
+  if (matrix.xx != 1.0 || matrix.yy != 1.0 || matrix.xy != 0.0 || matrix.yx != 0.0) return false;
+
+  double scale = 1.0, scale_y = 1.0;
+  cairo_ctx->get_target()->get_device_scale(scale, scale_y);
+  if (scale != scale_y || !(scale > 0.0)) return false;
+
+  const uint32_t radius_steps = std::max((uint32_t)std::lround(r / RADIUS_STEP), (uint32_t)1);
+  const Sprite &sprite = get_sprite(radius_steps, color, scale);
+
+  // Top-Left Snapped in Device Space, so the Blit needs no Filtering.
+  const double left = std::round((x + matrix.x0 - sprite.center) * scale) / scale - matrix.x0;
+  const double top = std::round((y + matrix.y0 - sprite.center) * scale) / scale - matrix.y0;
+
+  cairo_ctx->set_source(sprite.surface, left, top);
+  cairo_ctx->rectangle(left, top, sprite.size, sprite.size);
+  cairo_ctx->fill();
+  return true;
+}
+
+/**
+ * Drops every sprite, freeing their surfaces.
+ */
+void SpriteCache::clear() {
+  sprites.clear();
+  lru.clear();
+}
+
+size_t SpriteCache::size() const {
+  return sprites.size();
+}
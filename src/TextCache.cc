@@ -0,0 +1,212 @@
+#include "TextCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Resolves the font face, so drawing never looks it up again.
+ */
+TextCache::TextCache() {
+  font_face = Cairo::ToyFontFace::create("Sans", Cairo::FONT_SLANT_NORMAL, Cairo::FONT_WEIGHT_NORMAL);
+  frame = 0;
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Finds the entry for a string at a font size and color, measuring it on
+ *  first use.
+ *
+ * @param cairo_ctx - Context to measure with
+ * @param text - Text to find
+ * @param font_size - Font size
+ * @param rgba - RGBA8 color, 0 for measuring only
+ * @param scale - Device scale the surface is rendered at, 0 for measuring only
+ * @return Entry of the string
+ */
+TextCache::Entry &TextCache::get_entry(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, const char *text, double font_size, uint32_t rgba, double scale) {
+  key.assign(text);
+  key.push_back('\0');
+  key.append((const char*)&font_size, sizeof(font_size));
+  key.append((const char*)&rgba, sizeof(rgba));
+  key.append((const char*)&scale, sizeof(scale));
+
+  auto found = entries.find(key);
+  if (found != entries.end()) return found->second;
+
+  Entry entry{};
+  set_font(cairo_ctx, font_size);
+  cairo_ctx->get_text_extents(text, entry.extents);
+  entry.last_frame = frame;
+
+  // Keys Live in the Map Node, so their Address is Stable
+  auto inserted = entries.emplace(key, entry).first;
+  one_off.push_front(&inserted->first);
+  inserted->second.age_slot = one_off.begin();
+  return inserted->second;
+}
+
+/**
+ * Moves an entry to the front of the age list its uses put it in.
+ *
+ * @param entry - Entry just drawn or measured
+ */
+void TextCache::touch(Entry &entry) {
+  const bool now_repeating = entry.uses >= 2;
+  AgeList &from = entry.repeating ? repeating : one_off;
+  AgeList &to = now_repeating ? repeating : one_off;
+  to.splice(to.begin(), from, entry.age_slot);
+  entry.repeating = now_repeating;
+}
+
+/**
+ * Drops entries from the back of an age list until the oldest left was used
+ *  less than the given frames ago.
+ *
+ * @param ages - Age list to expire
+ * @param keep - Frames an unused entry is kept
+ */
+void TextCache::expire(AgeList &ages, uint64_t keep) {
+  while (!ages.empty()) {
+    auto oldest = entries.find(*ages.back());
+    if (frame - oldest->second.last_frame < keep) break;
+    ages.pop_back();
+    entries.erase(oldest);
+  }
+}
+
+/**
+ * Renders a string into the entry's surface at the given device scale,
+ *  padded by a device pixel for anti-aliasing. The origin sits on a whole
+ *  device pixel, so blits snapped to device pixels need no filtering.
+ */
+void TextCache::render_surface(Entry &entry, const char *text, double font_size, const RgbaColor &color, double scale) {
+  const Cairo::TextExtents &extents = entry.extents;
+  const int width = (int)std::ceil(extents.width * scale) + 3;
+  const int height = (int)std::ceil(extents.height * scale) + 3;
+  entry.origin_x = (1.0 - std::floor(extents.x_bearing * scale)) / scale;
+  entry.origin_y = (1.0 - std::floor(extents.y_bearing * scale)) / scale;
+  entry.width = width / scale;
+  entry.height = height / scale;
+
+  entry.surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+  entry.surface->set_device_scale(scale, scale);
+
+  auto surface_ctx = Cairo::Context::create(entry.surface);
+  set_font(surface_ctx, font_size);
+  surface_ctx->set_source_rgba(color.r, color.g, color.b, color.a);
+  surface_ctx->move_to(entry.origin_x, entry.origin_y);
+  surface_ctx->show_text(text);
+  entry.surface->flush();
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Selects the cached font face and the given size.
+ *
+ * @param cairo_ctx - Context to select on
+ * @param font_size - Font size
+ */
+void TextCache::set_font(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, double font_size) {
+  cairo_ctx->set_font_face(font_face);
+  cairo_ctx->set_font_size(font_size);
+}
+
+/**
+ * @param cairo_ctx - Context to measure with on a miss
+ * @param text - Text to measure
+ * @param font_size - Font size
+ * @return Extents of the text, valid until the next end_frame
+ */
+const Cairo::TextExtents &TextCache::get_extents(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, const char *text, double font_size) {
+  Entry &entry = get_entry(cairo_ctx, text, font_size, 0, 0.0);
+  entry.last_frame = std::max(entry.last_frame, frame);
+  touch(entry);
+  return entry.extents;
+}
+
+/**
+ * Draws text with its origin at (x, y). A string drawn on consecutive frames
+ *  is blitted from its rendered surface, placed on whole device pixels;
+ *  otherwise, or under a transform other than translation or a non-uniform
+ *  device scale, it is drawn with show_text.
+ *
+ * @param cairo_ctx - Context to draw on
+ * @param x - x-coordinate of the text origin
+ * @param y - y-coordinate of the text origin
+ * @param text - Text to draw
+ * @param font_size - Font size
+ * @param color - Text color
+ */
+void TextCache::draw_text(const Cairo::RefPtr<Cairo::Context> &cairo_ctx, double x, double y, const char *text, double font_size, const RgbaColor &color) {
+  double scale = 1.0, scale_y = 1.0;
+  cairo_ctx->get_target()->get_device_scale(scale, scale_y);
+  Entry &entry = get_entry(cairo_ctx, text, font_size, to_rgba8(color), scale);
+
+  // Count Frames in a Row the String was Drawn
+  if (entry.uses == 0 || entry.last_frame + 1 < frame)
+    entry.uses = 1;
+  else if (entry.last_frame + 1 == frame)
+    entry.uses++;
+  entry.last_frame = frame;
+  touch(entry);
+
+  Cairo::Matrix matrix;
+  cairo_ctx->get_matrix(matrix);
+  const bool translation_only = matrix.xx == 1.0 && matrix.yy == 1.0 && matrix.xy == 0.0 && matrix.yx == 0.0;
+  const bool uniform_scale = scale == scale_y && scale > 0.0;
+
+  // CHANGING TEXT: Straight to Cairo
+  if (entry.uses < 2 || !translation_only || !uniform_scale || text[0] == '\0') {
+    set_font(cairo_ctx, font_size);
+    cairo_ctx->set_source_rgba(color.r, color.g, color.b, color.a);
+    cairo_ctx->move_to(x, y);
+    cairo_ctx->show_text(text);
+    cairo_ctx->begin_new_path();
+    return;
+  }
+
+  // REPEATING TEXT: Blit, Rendering only if New
+  if (!entry.surface)
+    render_surface(entry, text, font_size, color, scale);
+
+  // Origin Snapped in Device Space
+  const double left = std::round((x + matrix.x0) * scale) / scale - matrix.x0 - entry.origin_x;
+  const double top = std::round((y + matrix.y0) * scale) / scale - matrix.y0 - entry.origin_y;
+  cairo_ctx->set_source(entry.surface, left, top);
+  cairo_ctx->rectangle(left, top, entry.width, entry.height);
+  cairo_ctx->fill();
+
+  // Leave the Source as show_text would have.
+  cairo_ctx->set_source_rgba(color.r, color.g, color.b, color.a);
+}
+
+/**
+ * Ends the frame, dropping strings seen once that were not drawn again, and
+ *  repeating strings that have not been drawn for STALE_FRAMES frames. Only
+ *  the expired strings at the back of the age lists are visited.
+ */
+void TextCache::end_frame() {
+  expire(one_off, ONE_OFF_FRAMES);
+  expire(repeating, STALE_FRAMES);
+  frame++;
+}
+
+/**
+ * Drops every cached string.
+ */
+void TextCache::clear() {
+  one_off.clear();
+  repeating.clear();
+  entries.clear();
+}
+
+size_t TextCache::size() const {
+  return entries.size();
+}
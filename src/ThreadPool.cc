@@ -0,0 +1,163 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+
+/* CONSTRUCTORS / DESTRUCTORS */
+
+/**
+ * Starts the worker threads.
+ *
+ * @param thread_count - Total threads including the caller, 0 for the
+ *  hardware concurrency
+ */
+ThreadPool::ThreadPool(size_t thread_count) {
+  if (thread_count == 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+  job = nullptr;
+  remaining = 0;
+  generation = 0;
+  stopping = false;
+
+  for (size_t i = 0; i < thread_count; i++)
+    queues.push_back(std::make_unique<WorkerQueue>());
+
+  for (size_t i = 1; i < thread_count; i++)
+    workers.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+/**
+ * Stops and joins the worker threads.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Takes the next chunk from the worker's own queue, or steals one from the
+ *  back of another worker's queue.
+ *
+ * @param worker - Index of the calling worker
+ * @param range - Stores the chunk taken
+ * @return True if a chunk was taken
+ */
+bool ThreadPool::pop_range(size_t worker, Range &range) {
+  const size_t count = queues.size();
+  for (size_t k = 0; k < count; k++) {
+    const size_t victim = (worker + k) % count;
+    WorkerQueue &queue = *queues[victim];
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) continue;
+
+    if (victim == worker) {
+      range = queue.ranges.front();
+      queue.ranges.pop_front();
+    } else {
+      range = queue.ranges.back();
+      queue.ranges.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Runs chunks until every queue is empty.
+ *
+ * @param worker - Index of the calling worker
+ */
+void ThreadPool::run_ranges(size_t worker) {
+  Range range;
+  while (pop_range(worker, range)) {
+    (*job)(range.begin, range.end, worker);
+
+    if (remaining.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(mutex);
+      done.notify_all();
+    }
+  }
+}
+
+/**
+ * Worker thread entry, sleeps until new work or shutdown.
+ *
+ * @param worker - Index of this worker
+ */
+void ThreadPool::worker_loop(size_t worker) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&]() { return stopping || generation != seen_generation; });
+      if (stopping) return;
+      seen_generation = generation;
+    }
+
+    run_ranges(worker);
+  }
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Runs fn over [0, count) across every thread and waits for completion. The
+ *  chunk boundaries only depend on count, grain and the thread count.
+ *
+ * @param count - Number of items
+ * @param grain - Minimum number of items per chunk
+ * @param fn - Loop body, called with [begin, end) and the worker index
+ */
+void ThreadPool::parallel_for(size_t count, size_t grain, const RangeFn &fn) {
+  if (count == 0) return;
+
+  // Serial: Skip the Queues Entirely
+  const size_t threads = queues.size();
+  if (threads == 1 || count <= grain) {
+    fn(0, count, 0);
+    return;
+  }
+
+  // ~4 Chunks per Thread leaves Room for Stealing
+  const size_t chunk = std::max(std::max<size_t>(grain, 1), (count + threads * 4 - 1) / (threads * 4));
+  const size_t chunks = (count + chunk - 1) / chunk;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &fn;
+    remaining = chunks;
+
+    // Contiguous Blocks of Chunks per Thread
+    for (size_t c = 0; c < chunks; c++) {
+      WorkerQueue &queue = *queues[c * threads / chunks];
+      std::lock_guard<std::mutex> queue_lock(queue.mutex);
+      queue.ranges.push_back({ c * chunk, std::min(count, (c + 1) * chunk) });
+    }
+    generation++;
+  }
+  wake.notify_all();
+
+  run_ranges(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&]() { return remaining == 0; });
+  job = nullptr;
+}
+
+/**
+ * @return Number of threads working on a parallel_for, including the caller
+ */
+size_t ThreadPool::get_thread_count() const {
+  return queues.size();
+}
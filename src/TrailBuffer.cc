@@ -0,0 +1,93 @@
+#include "TrailBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty buffer, sized on its first frame.
+ *
+ * @param decay - Fraction of each pixel kept per frame
+ */
+TrailBuffer::TrailBuffer(double decay) {
+  fade = get_fade_kernel(detect_simd_level());
+  set_decay(decay);
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Starts a frame: fades everything stamped so far by the decay factor once
+ *  per step, or creates a cleared surface if there is none, the size changed
+ *  or the steps would fade it out anyway.
+ *
+ * @param width - Width of the area
+ * @param height - Height of the area
+ * @param steps - Steps since the last frame, each fading the buffer once
+ */
+void TrailBuffer::begin_frame(int width, int height, size_t steps) {
+  if (width <= 0 || height <= 0) return;
+
+  // FADED OUT: Cheaper to Start Over
+  if (surface && std::pow(factor / 256.0, (double)steps) * 255.0 < 0.5)
+    clear();
+
+  if (!surface || surface->get_width() != width || surface->get_height() != height) {
+    surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+    stamp_ctx = Cairo::Context::create(surface);
+    return;
+  }
+
+  // DECAY: Fade Row by Row, Rows may be Padded
+  if (factor >= 256 || steps == 0) return;
+  surface->flush();
+  uint8_t *data = surface->get_data();
+  const int stride = surface->get_stride();
+  for (int y = 0; y < height; y++) {
+    uint32_t *row = (uint32_t*)(data + (size_t)y * stride);
+    for (size_t step = 0; step < steps; step++)
+      fade(row, width, factor);
+  }
+  surface->mark_dirty();
+}
+
+const Cairo::RefPtr<Cairo::Context> &TrailBuffer::get_context() const {
+  return stamp_ctx;
+}
+
+/**
+ * Paints the accumulated trails over the context.
+ *
+ * @param cairo_ctx - Context to draw on
+ */
+void TrailBuffer::composite(const Cairo::RefPtr<Cairo::Context> &cairo_ctx) {
+  if (!surface) return;
+
+  surface->flush();
+  cairo_ctx->save();
+  cairo_ctx->set_source(surface, 0, 0);
+  cairo_ctx->paint();
+  cairo_ctx->restore();
+}
+
+/**
+ * @param decay - Fraction of each pixel kept per step, 0 for no trails and
+ *  1 for trails that never fade
+ */
+void TrailBuffer::set_decay(double decay) {
+  factor = (uint32_t)std::lround(std::min(std::max(decay, 0.0), 1.0) * 256.0);
+}
+
+double TrailBuffer::get_decay() const {
+  return factor / 256.0;
+}
+
+/**
+ * Erases all trails. The buffer is recreated on the next frame.
+ */
+void TrailBuffer::clear() {
+  surface = Cairo::RefPtr<Cairo::ImageSurface>();
+  stamp_ctx = Cairo::RefPtr<Cairo::Context>();
+}
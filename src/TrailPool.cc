@@ -0,0 +1,97 @@
+#include "TrailPool.h"
+#include <algorithm>
+
+
+/* CONSTRUCTORS */
+
+/**
+ * Creates an empty pool.
+ *
+ * @param capacity - Max points per trail
+ */
+TrailPool::TrailPool(size_t capacity) {
+  this->capacity = capacity;
+}
+
+
+/* PUBLIC FUNCTIONS */
+
+/**
+ * Adds an empty trail to the pool.
+ *
+ * @return Index of the new trail
+ */
+size_t TrailPool::add() {
+  points.resize(points.size() + capacity);
+  heads.push_back(0);
+  counts.push_back(0);
+  return heads.size() - 1;
+}
+
+/**
+ * Removes all trails from the pool.
+ */
+void TrailPool::clear() {
+  points.clear();
+  heads.clear();
+  counts.clear();
+}
+
+/**
+ * Appends a point to a trail, overwriting the oldest point if it is full.
+ *  Only touches the given trail's slots, so different trails can be pushed
+ *  to from different threads.
+ *
+ * @param trail - Index of the trail
+ * @param point - Point to append
+ */
+void TrailPool::push(size_t trail, Vector2D point) {
+  if (capacity == 0) return;
+
+  uint32_t &head = heads[trail];
+  uint32_t &count = counts[trail];
+  if (count < capacity) {
+    size_t slot = head + count;
+    if (slot >= capacity) slot -= capacity;
+    points[trail * capacity + slot] = point;
+    count++;
+  } else {
+    points[trail * capacity + head] = point;
+    head = head + 1 == capacity ? 0 : head + 1;
+  }
+}
+
+/**
+ * Brings this pool, a copy of source taken the given number of pushes per
+ *  trail ago, up to date by pushing only the newest points of each trail.
+ *  Falls back to a full copy when the pools don't line up or the copy is
+ *  a whole trail or more behind.
+ *
+ * @param source - Pool to catch up with
+ * @param pushes - Points pushed onto each of source's trails since the copy
+ */
+void TrailPool::catch_up(const TrailPool &source, uint64_t pushes) {
+  if (capacity != source.capacity || heads.size() != source.heads.size() || pushes >= capacity) {
+    *this = source;
+    return;
+  }
+
+  for (size_t trail = 0; trail < heads.size(); trail++) {
+    const size_t count = source.counts[trail];
+    const size_t newest = std::min<size_t>(pushes, count);
+    for (size_t k = count - newest; k < count; k++)
+      push(trail, source.get(trail, k));
+  }
+}
+
+size_t TrailPool::size(size_t trail) const {
+  return counts[trail];
+}
+
+size_t TrailPool::get_capacity() const {
+  return capacity;
+}
+
+size_t TrailPool::get_trail_count() const {
+  return heads.size();
+}
@@ -0,0 +1,155 @@
+// CORE CLASSES
+#include "Simulation.h"
+
+// LIBRARIES
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+/**
+ * Headless Simulation Benchmark
+ *  Runs the body simulation for a number of steps without a display and
+ *  prints the results as JSON on stdout.
+ */
+struct HeadlessOptions {
+  size_t        bodies;
+  size_t        steps;
+  FORCE_MODE    force_mode;
+  double        theta;
+  size_t        threads;                  // 0 = Hardware Concurrency
+  SIMD_LEVEL    simd_level;
+  unsigned int  seed;
+};
+
+static void print_usage(const char *program) {
+  fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  --bodies N          Number of bodies (default 2000)\n"
+    "  --steps N           Number of steps to run (default 100)\n"
+    "  --mode MODE         direct | barnes-hut (default direct)\n"
+    "  --theta T           Barnes-Hut opening angle (default 0.5)\n"
+    "  --threads N         Physics threads, 0 for all cores (default 0)\n"
+    "  --simd LEVEL        scalar | sse2 | avx2 | avx512 (default best supported)\n"
+    "  --seed N            Scene random seed (default 1)\n",
+    program
+  );
+}
+
+/**
+ * Parses the command line into options.
+ *
+ * @return False if the arguments are invalid
+ */
+static bool parse_options(int argc, char *argv[], HeadlessOptions &opts) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const char *value = argv[++i];
+
+    if (!strcmp(arg, "--bodies"))       opts.bodies = strtoull(value, nullptr, 10);
+    else if (!strcmp(arg, "--steps"))   opts.steps = strtoull(value, nullptr, 10);
+    else if (!strcmp(arg, "--theta"))   opts.theta = strtod(value, nullptr);
+    else if (!strcmp(arg, "--threads")) opts.threads = strtoull(value, nullptr, 10);
+    else if (!strcmp(arg, "--seed"))    opts.seed = strtoul(value, nullptr, 10);
+    else if (!strcmp(arg, "--mode")) {
+      if (!strcmp(value, "direct"))           opts.force_mode = DIRECT_SUM;
+      else if (!strcmp(value, "barnes-hut"))  opts.force_mode = BARNES_HUT;
+      else return false;
+    }
+    else if (!strcmp(arg, "--simd")) {
+      if (!strcmp(value, "scalar"))       opts.simd_level = SCALAR;
+      else if (!strcmp(value, "sse2"))    opts.simd_level = SSE2;
+      else if (!strcmp(value, "avx2"))    opts.simd_level = AVX2;
+      else if (!strcmp(value, "avx512"))  opts.simd_level = AVX512;
+      else return false;
+    }
+    else return false;
+  }
+  return true;
+}
+
+/**
+ * Fills the simulation with a slowly rotating disc of bodies, the same size
+ *  as the default window.
+ */
+static void build_scene(Simulation &simulation, const HeadlessOptions &opts) {
+  std::mt19937 rng(opts.seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const double center = 400.0, disc_radius = 380.0;
+
+  simulation.get_bodies().reserve(opts.bodies);
+  for (size_t i = 0; i < opts.bodies; i++) {
+    const double r = disc_radius * std::sqrt(unit(rng));
+    const double angle = unit(rng) * 2.0 * M_PI;
+    const double speed = 0.05 * r / disc_radius;
+
+    simulation.add_body(
+      Vector2D{ center + r * std::cos(angle), center + r * std::sin(angle) },
+      1.0 + 49.0 * unit(rng),
+      2.0,
+      Vector2D{ -speed * std::sin(angle), speed * std::cos(angle) },
+      Vector2D{ 0.0, 0.0 }
+    );
+  }
+}
+
+/**
+ * @return Peak resident memory of the process in bytes
+ */
+static long long peak_memory_bytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (long long)usage.ru_maxrss * 1024;   // Linux reports KiB
+}
+
+
+int main(int argc, char *argv[]) {
+  HeadlessOptions opts{
+    .bodies = 2000,
+    .steps = 100,
+    .force_mode = DIRECT_SUM,
+    .theta = 0.5,
+    .threads = 0,
+    .simd_level = detect_simd_level(),
+    .seed = 1,
+  };
+  if (!parse_options(argc, argv, opts)) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  // SETUP SIMULATION
+  Simulation simulation;
+  simulation.set_force_mode(opts.force_mode);
+  simulation.set_theta(opts.theta);
+  simulation.set_thread_count(opts.threads);
+  simulation.set_simd_level(opts.simd_level);
+  build_scene(simulation, opts);
+
+  // RUN
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < opts.steps; i++)
+    simulation.step();
+  auto end = std::chrono::steady_clock::now();
+
+  // REPORT: Pair count is the direct sum's, so both modes are comparable
+  const double elapsed_s = std::chrono::duration<double>(end - start).count();
+  const double pairs = (double)opts.steps * opts.bodies * (opts.bodies > 0 ? opts.bodies - 1 : 0);
+
+  printf("{\n");
+  printf("  \"bodies\": %zu,\n", opts.bodies);
+  printf("  \"steps\": %zu,\n", opts.steps);
+  printf("  \"mode\": \"%s\",\n", opts.force_mode == DIRECT_SUM ? "direct" : "barnes-hut");
+  printf("  \"theta\": %.3f,\n", opts.theta);
+  printf("  \"threads\": %zu,\n", simulation.get_thread_count());
+  printf("  \"simd\": \"%s\",\n", simd_level_name(simulation.get_simd_level()));
+  printf("  \"elapsed_s\": %.6f,\n", elapsed_s);
+  printf("  \"steps_per_sec\": %.3f,\n", elapsed_s > 0 ? opts.steps / elapsed_s : 0.0);
+  printf("  \"ns_per_pair\": %.4f,\n", pairs > 0 ? elapsed_s * 1e9 / pairs : 0.0);
+  printf("  \"peak_memory_bytes\": %lld\n", peak_memory_bytes());
+  printf("}\n");
+  return 0;
+}
@@ -1,36 +1,13 @@
 // CORE CLASSES
 #include "MyWindow.h"
+#include "PhysicsThread.h"
 #include "spdlog/spdlog.h"
 
 // MATHS
 #define _USE_MATH_DEFINES
 #include <math.h>
-#include <deque>
-
-const double GRAVITATIONAL_CONST = 1.f;
-
-struct Vector2D {
-  double x;
-  double y;
-};
-
-struct Body {
-  // Coordinates.
-  Vector2D pos;
-
-  RgbaColor color;
-
-  // TODO: implement better bounding.
-  double radius;
-
-  // Physics!
-  double mass;
-  Vector2D velocity;
-  Vector2D acceleration;
-
-  std::deque<Vector2D> trail;
-  size_t max_trail_size;
-};
+#include <algorithm>
+#include <cstring>
 
 // Static color definitions.
 static const RgbaColor RED{
@@ -76,9 +53,13 @@ static const RgbaColor BACKGROUND_COLOR{
  */
 class MyApp: public ContextArea {
   public:
-    MyApp() {
+    MyApp() : physics(simulation, 60.0) {
       spdlog::info("MyApp Constructed");
       init_context_area(TARGET_FPS::SIXTY);
+      enable_draw_batching(true);             // Bodies, lines and stats drawn in sorted batches
+      enable_circle_sprites(true);            // Bodies and trails blitted from cached circles
+      spdlog::info("Direct sum kernel: {}", simd_level_name(simulation.get_simd_level()));
+      spdlog::info("Physics threads: {}", simulation.get_thread_count());
     }
 
 
@@ -89,218 +70,217 @@ class MyApp: public ContextArea {
         return false;
       }
 
+      // Simulation changes run on the physics thread between ticks.
+      if(event->keyval == GDK_KEY_b) {        // Toggle Gravity Solver on 'B'
+        physics.post([](Simulation &sim) {
+          FORCE_MODE mode = sim.get_force_mode() == DIRECT_SUM ? BARNES_HUT : DIRECT_SUM;
+          sim.set_force_mode(mode);
+          spdlog::info("Force mode: {}", mode == DIRECT_SUM ? "Direct Sum" : "Barnes-Hut");
+        });
+      }
+
+      if(event->keyval == GDK_KEY_bracketleft) {    // Decrease Barnes-Hut Opening Angle on '['
+        physics.post([](Simulation &sim) {
+          sim.set_theta(std::max(0.0, sim.get_theta() - 0.1));
+          spdlog::info("Barnes-Hut theta: {:.2f}", sim.get_theta());
+        });
+      }
+
+      if(event->keyval == GDK_KEY_bracketright) {   // Increase Barnes-Hut Opening Angle on ']'
+        physics.post([](Simulation &sim) {
+          sim.set_theta(std::min(2.0, sim.get_theta() + 0.1));
+          spdlog::info("Barnes-Hut theta: {:.2f}", sim.get_theta());
+        });
+      }
+
+      if(event->keyval == GDK_KEY_t) {        // Toggle Single/All Physics Threads on 'T'
+        physics.post([](Simulation &sim) {
+          sim.set_thread_count(sim.get_thread_count() == 1 ? 0 : 1);
+          spdlog::info("Physics threads: {}", sim.get_thread_count());
+        });
+      }
+
+      if(event->keyval == GDK_KEY_e) {        // Compare Barnes-Hut against Direct Sum on 'E'
+        physics.post([](Simulation &sim) {
+          double rms_error, max_error;
+          sim.measure_force_error(rms_error, max_error);
+          spdlog::info("Barnes-Hut theta[{:.2f}] vs Direct Sum: rms[{:.4f}%] max[{:.4f}%]",
+            sim.get_theta(), rms_error * 100.f, max_error * 100.f);
+        });
+      }
+
+      if(event->keyval == GDK_KEY_p) {        // Toggle Persistent (Accumulated) Trails on 'P'
+        persistent_trails = !persistent_trails;
+        clear_trail_buffer();
+        spdlog::info("Trails: {}", persistent_trails ? "Persistent" : "Replayed");
+      }
+
+      if(event->keyval == GDK_KEY_f) {        // Toggle Splatting Bodies into the Framebuffer on 'F'
+        framebuffer_bodies = !framebuffer_bodies;
+        spdlog::info("Bodies: {}", framebuffer_bodies ? "Framebuffer" : "Cairo");
+      }
+
+      // Camera: Pan with the Arrow Keys, Zoom around the Center with +/-, Reset with '0'
+      Gtk::Allocation allocation = get_allocation();
+      const double center_x = allocation.get_width() / 2.0, center_y = allocation.get_height() / 2.0;
+      if(event->keyval == GDK_KEY_Left)   get_camera().pan(PAN_STEP, 0.0);
+      if(event->keyval == GDK_KEY_Right)  get_camera().pan(-PAN_STEP, 0.0);
+      if(event->keyval == GDK_KEY_Up)     get_camera().pan(0.0, PAN_STEP);
+      if(event->keyval == GDK_KEY_Down)   get_camera().pan(0.0, -PAN_STEP);
+      if(event->keyval == GDK_KEY_plus || event->keyval == GDK_KEY_equal)
+        get_camera().zoom_at(ZOOM_STEP, center_x, center_y);
+      if(event->keyval == GDK_KEY_minus)
+        get_camera().zoom_at(1.0 / ZOOM_STEP, center_x, center_y);
+      if(event->keyval == GDK_KEY_0)
+        get_camera().reset();
+
+      if(event->keyval == GDK_KEY_r) {        // Start/Stop Recording to recording.y4m on 'R'
+        if (is_recording())
+          stop_recording();
+        else
+          start_recording("recording.y4m");
+      }
+
       // Return True to keep Running
       return true;
     }
 
-    bool on_key_release(GdkEventKey* event) {     // Similair to KeyPress
+    bool on_key_release(GdkEventKey*) {     // Similair to KeyPress
       // Return True to keep Running
       return true;
     }
 
-    bool on_mouse_press(GdkEventButton* event) {
+    bool on_mouse_press(GdkEventButton*) {
       return true;
     }
 
   private:    // DRAWING FUNCTIONS
-    std::vector<Body> bodies;
+    Simulation simulation;
+    PhysicsThread physics;                    // Steps simulation at a Fixed Rate, Declared after it
+    std::vector<RgbaColor> body_colors;       // Color of each Body, by Body index
+    size_t background_layer;                  // Static Backdrop, Painted Once
+    bool persistent_trails = false;           // Trails Faded in a Buffer instead of Replayed
+    uint64_t trail_step = 0;                  // Snapshot Step Last Stamped into the Trail Buffer
+    bool framebuffer_bodies = false;          // Bodies Splatted as Raw Pixels instead of Cairo Circles
+
+    static constexpr double STATS_REACH = 300.0;    // Screen Pixels Body Stats Text can Reach
+    static constexpr double PAN_STEP = 50.0;        // Screen Pixels per Arrow Key
+    static constexpr double ZOOM_STEP = 1.25;       // Zoom Factor per +/- Key
+
+    void add_body(Vector2D pos, RgbaColor color, double radius, double mass, Vector2D velocity, Vector2D acceleration) {
+      simulation.add_body(pos, mass, radius, velocity, acceleration);
+      body_colors.push_back(color);
+    }
 
     void setup(const Context& ctx) {
       spdlog::info("SETTING UP...");
 
-      this->bodies.push_back({
+      background_layer = add_layer([this](const Context& layer_ctx) {
+        background(layer_ctx, BACKGROUND_COLOR);
+      });
+
+      add_body(
         // Intiial position.
-        .pos = Vector2D{
+        Vector2D{
           .x = ctx.width / 2.f,
           .y = ctx.height / 2.f,
         },
-        .color = RED,
-        .radius = 20.f,
+        RED,
+        20.f,
 
         // Initial force.
-        .mass = 500.f,
-        .velocity = Vector2D{
+        500.f,
+        Vector2D{
           .x = 0.f,
           .y = 0.f,
         },
-        .acceleration = Vector2D{
+        Vector2D{
           .x = 0.f,
           .y = 0.f,
-        },
-        .max_trail_size = 32,
-      });
+        }
+      );
 
-      this->bodies.push_back({
+      add_body(
         // Intiial position.
-        .pos = Vector2D{
+        Vector2D{
           .x = (ctx.width / 2.f) + (20.f * 4.f),
           .y = ctx.height / 2.f,
         },
-        .color = BLUE,
-        .radius = 20.f,
+        BLUE,
+        20.f,
 
         // Initial force.
-        .mass = 10.f,
-        .velocity = Vector2D{
+        10.f,
+        Vector2D{
           .x = 0.f,
           .y = 0.f,
         },
-        .acceleration = Vector2D{
+        Vector2D{
           .x = 0.f,
           .y = 2.5f,
-        },
-        .max_trail_size = 32,
-      });
-    }
-
-    // Transfers energy from one body to another.
-    void transfer_energy(Body *b1, Body *b2) {
-      // Conservation of momentum!
-      double total_mass = b1->mass + b2->mass;
-
-      Vector2D b1_v{
-        ( 2.f * b2->mass * b2->velocity.x + (b1->mass - b2->mass) * b1->velocity.x) / total_mass,
-        ( 2.f * b2->mass * b2->velocity.y + (b1->mass - b2->mass) * b1->velocity.y) / total_mass,
-      };
-      Vector2D b2_v{
-        ( 2.f * b1->mass * b1->velocity.x + (b2->mass - b1->mass) * b2->velocity.x) / total_mass,
-        ( 2.f * b1->mass * b1->velocity.y + (b2->mass - b1->mass) * b2->velocity.y) / total_mass,
-      };
-
-      b1->velocity = b1_v;
-      b2->velocity = b2_v;
-    }
-
-    double distance(const Body &body1, const Body &body2) {
-      return std::sqrt(
-        std::pow(body2.pos.x - body1.pos.x, 2) + std::pow(body2.pos.y - body1.pos.y, 2)
+        }
       );
 
+      // Bodies are in place, hand the simulation over to the physics thread.
+      //  Offscreen frames step it themselves, so runs are repeatable.
+      if (!is_offscreen())
+        physics.start();
     }
 
-    Vector2D midpoint(const Body &b1, const Body &b2) {
-      double dx = b2.pos.x - b1.pos.x;
-      double dy = b2.pos.y - b1.pos.y;
-      return {
-        b1.pos.x + (dx / 2.f),
-        b1.pos.y + (dy / 2.f)
-      };
-    }
-
-    bool is_collide(const Body &b1, const Body &b2) {
-      double d = distance(b1, b2);
-      return b1.radius + b2.radius > d;
-    }
-
-    void unlodge_bodies(Body *b1, Body *b2) {
-      double d = distance(*b1, *b2);
-      double dx = (b2->pos.x - b1->pos.x) / d;
-      double dy = (b2->pos.y - b1->pos.y) / d;
-
-      b1->pos.x -= dx;
-      b1->pos.y -= dy;
-    }
-
-    // Calculates the force exertered on body1 from body2.
-    Vector2D calculate_force_on_body(const Body &body1, const Body &body2) {
-      double r = distance(body1, body2);
-      double f_mag = GRAVITATIONAL_CONST * ( (body1.mass * body2.mass) / std::pow(r, 2) );
-      double angle = std::atan2( body2.pos.y - body1.pos.y, body2.pos.x - body1.pos.x );
-      return { f_mag * std::cos(angle), f_mag * std::sin(angle) };
-    }
-
-    void draw_force_on_body(const Context &ctx, const Body &b1, Vector2D force) {
+    void draw_force_on_body(const Context &ctx, const BodyStore &bodies, size_t i, Vector2D force) {
       // Magical multiplier to so we can see the force arrow.
       Vector2D p1{
-        b1.pos.x + force.x / b1.mass,
-        b1.pos.y + force.y / b1.mass,
+        bodies.x[i] + force.x / bodies.mass[i],
+        bodies.y[i] + force.y / bodies.mass[i],
       };
 
       draw_line(
         ctx,
-        b1.pos,
+        Vector2D{ bodies.x[i], bodies.y[i] },
         p1,
         GREEN
       );
     }
 
-    void update_physics(const Context &ctx, std::vector<Body> &bodies) {
-      for (size_t i = 0; i < bodies.size(); i++) {
-        Body *body = &bodies[i];
-
-        // Calculate the gravitational force between all bodies.
-        for (size_t j = 0; j < bodies.size(); j++) {
-          // Ignore self.
-          if (i == j) continue;
-          Body other_body = bodies[j];
-
-          Vector2D force = calculate_force_on_body(*body, other_body);
-          draw_force_on_body(ctx, *body, force);
-
-          if (is_collide(*body, other_body)) {
-            transfer_energy(body, &other_body);
-            unlodge_bodies(body, &other_body);
-          }
-
-          // Update acceleration on each other.
-          body->acceleration.x += force.x / body->mass;
-          body->acceleration.y += force.y / body->mass;
-        }
-
-        // Update velocity and displacement.
-        body->velocity.x += body->acceleration.x;
-        body->velocity.y += body->acceleration.y;
-
-        body->pos.x += body->velocity.x;
-        body->pos.y += body->velocity.y;
-
-        // Reset acceleration.
-        body->acceleration.x = 0.f;
-        body->acceleration.y = 0.f;
-
-        draw_body_stats(ctx, *body);
-      }
-
-    }
-
-    void draw_body_stats(const Context &ctx, const Body &body) {
+    void draw_body_stats(const Context &ctx, const BodyStore &bodies, size_t i) {
       // STATS/DEBUG: //
       double text_offset = 18.f;
       double font_size = 12.f;
+      const double x = bodies.x[i], y = bodies.y[i];
+      const double vx = bodies.vx[i], vy = bodies.vy[i];
 
       // Draw the circle body's state stats.
       set_color(ctx, RED);
       set_font_size(ctx, font_size);
       char body_d_stat_buffer[255];
-      snprintf(body_d_stat_buffer, sizeof(body_d_stat_buffer), "d[x=%.2f|y=%2.f]", body.pos.x, body.pos.y);
+      snprintf(body_d_stat_buffer, sizeof(body_d_stat_buffer), "d[x=%.2f|y=%2.f]", x, y);
       draw_text(
         ctx,
-        body.pos.x,
-        body.pos.y - text_offset,
+        x,
+        y - text_offset,
         body_d_stat_buffer
       );
 
       char body_a_stat_buffer[255];
-      snprintf(body_a_stat_buffer, sizeof(body_a_stat_buffer), "a[x=%.2f|y=%2.f]", body.acceleration.x, body.acceleration.y);
+      snprintf(body_a_stat_buffer, sizeof(body_a_stat_buffer), "a[x=%.2f|y=%2.f]", bodies.ax[i], bodies.ay[i]);
       draw_text(
         ctx,
-        body.pos.x,
-        body.pos.y - (text_offset * 2.f),
+        x,
+        y - (text_offset * 2.f),
         body_a_stat_buffer
       );
 
 
       // Draw direction of force.
-      double magnitude = std::sqrt(body.velocity.x * body.velocity.x + body.velocity.y * body.velocity.y);
-      double direction_rad = std::atan2(body.velocity.y, body.velocity.x);
-      double direction_deg = direction_rad * 180.f / M_PI;
+      double magnitude = std::sqrt(vx * vx + vy * vy);
+      double direction_rad = std::atan2(vy, vx);
 
       draw_line(
         ctx,
-        body.pos,
+        Vector2D{ x, y },
         Vector2D{
-          .x = body.pos.x + magnitude * std::cos(direction_rad),
-          .y = body.pos.y + magnitude * std::sin(direction_rad),
+          .x = x + magnitude * std::cos(direction_rad),
+          .y = y + magnitude * std::sin(direction_rad),
         },
         RED
       );
@@ -309,67 +289,150 @@ class MyApp: public ContextArea {
       snprintf(body_mag_buffer, sizeof(body_mag_buffer), "mag=%.2f | direction=%.2frad", magnitude, direction_rad);
       draw_text(
         ctx,
-        body.pos.x,
-        body.pos.y - (text_offset * 3.f),
+        x,
+        y - (text_offset * 3.f),
         body_mag_buffer
       );
     }
 
     void draw_line(const Context& ctx, Vector2D pos1, Vector2D pos2, RgbaColor color) {
-      set_color(ctx, color);
-      ctx.cairo_ctx->set_line_width(10.f);
-      ctx.cairo_ctx->set_line_cap(Cairo::LINE_CAP_ROUND);
-      ctx.cairo_ctx->move_to(pos1.x, pos1.y);
-      ctx.cairo_ctx->line_to(pos2.x, pos2.y);
-      ctx.cairo_ctx->stroke();
+      line(ctx, pos1.x, pos1.y, pos2.x, pos2.y, 10.f, color);
+    }
+
+    void draw_body_on_mouse(const Context&, size_t i) {
+      double x, y;
+      this->get_mouse_position(x, y);
+      physics.post([i, x, y](Simulation &sim) {
+        sim.get_bodies().x[i] = x;
+        sim.get_bodies().y[i] = y;
+      });
     }
 
-    void draw_body_on_mouse(const Context& ctx, Body *body) {
-      this->get_mouse_position(body->pos.x, body->pos.y);
+    void update() {
+      // Offscreen frames step the simulation themselves, timed apart from drawing.
+      if (is_offscreen())
+        physics.tick();
     }
 
     void draw(const Context& ctx) {
       // Draw Background Color
-      background(ctx, BACKGROUND_COLOR);
+      draw_layer(ctx, background_layer);
 
       // Draw nerd info at the top right.
-      display_nerd_info(ctx);
-
-      // Draw them bodies.
-      for (Body &body : this->bodies) {
-        // Draw trail.
-        for (size_t i = 0; i < body.trail.size(); i++) {
-          const Vector2D &trail = body.trail[i];
-          RgbaColor color = CYAN;
-
+      const FrameStats::Summary physics_stats = physics.get_step_stats();
+      display_nerd_info(ctx, &physics_stats);
+
+      // Draw the latest state published by the physics thread.
+      const SimulationSnapshot &state = physics.latest_snapshot();
+      const BodyStore &bodies = state.bodies;
+      const TrailPool &trails = state.trails;
+
+      // Bodies, trails and forces are in world space, culled by the camera.
+      const Context world = world_context(ctx);
+      const Camera &camera = get_camera();
+
+      if (persistent_trails) {
+        // Stamp once per physics step, not per frame: the positions at the
+        //  start of each step since the last stamp come from the trails, then
+        //  the current ones. Older ones fade out with the buffer.
+        const size_t steps = state.step_count > trail_step ? state.step_count - trail_step : 0;
+        trail_step = state.step_count;
+        draw_trail_buffer(world, [this, &bodies, &trails, steps](const Context& trail_ctx) {
+          for (size_t b = 0; b < bodies.size(); b++) {
+            const size_t count = trails.size(b);
+            for (size_t k = count - std::min(steps - 1, count); k < count; k++) {
+              Vector2D point = trails.get(b, k);
+              circle(trail_ctx, point.x, point.y, bodies.radius[b] / 2.f, CYAN);
+            }
+            circle(trail_ctx, bodies.x[b], bodies.y[b], bodies.radius[b] / 2.f, CYAN);
+          }
+        }, steps);
+      } else {
+        // Draw trails, points of equal age (and alpha) share a sprite. Flushed
+        //  on their own so they stay beneath the bodies.
+        for (size_t i = 0; i < trails.get_capacity(); i++) {
           // Normalized change in trail alpha mapped to the number of max trails.
-          float trail_off_alpha_dt = 1.f - ((i - 0.f) / (body.max_trail_size - 0.f));
-          color.a = trail_off_alpha_dt;
+          RgbaColor color = CYAN;
+          color.a = 1.f - ((i - 0.f) / (trails.get_capacity() - 0.f));
 
-          circle(ctx, trail.x, trail.y, body.radius / 2.f, color);
+          for (size_t b = 0; b < trails.get_trail_count(); b++) {
+            if (i >= trails.size(b)) continue;
+            Vector2D point = trails.get(b, i);
+            circle(world, point.x, point.y, bodies.radius[b] / 2.f, color);
+          }
         }
+        flush_draw_list(ctx);
+      }
 
-        // Track trail.
-        if (body.trail.size() >= body.max_trail_size)
-          body.trail.pop_front();
-
-        // Copy the current state of the trail.
-        body.trail.push_back(body.pos);
-
-        circle(ctx, body.pos.x, body.pos.y, body.radius, body.color);
+      if (framebuffer_bodies) {
+        // The framebuffer is in screen pixels, so map through the camera here.
+        PixelBuffer &pixels = begin_pixels(ctx);
+        for (size_t b = 0; b < bodies.size(); b++) {
+          if (!camera.is_visible(bodies.x[b], bodies.y[b], bodies.radius[b])) continue;
+          double x, y;
+          camera.to_screen(bodies.x[b], bodies.y[b], x, y);
+          pixels.disc(x, y, bodies.radius[b] * camera.get_zoom(), body_colors[b]);
+        }
+        end_pixels(ctx);
+      } else {
+        // Sub-pixel bodies become pixels or density when zoomed out.
+        draw_bodies(world, bodies.x.data(), bodies.y.data(), bodies.radius.data(), body_colors.data(), bodies.size());
       }
 
       // DEBUG:
-      // draw_body_on_mouse(ctx, &this->bodies[0]);
-
-      // Update the physics on bodies.
-      update_physics(ctx, bodies);
+      // draw_body_on_mouse(ctx, 0);
+
+      // Draw the forces and stats of the step, for bodies big enough on screen.
+      //  Stats are only formatted for bodies near the screen, their text
+      //  reaches STATS_REACH pixels out.
+      const double stats_reach = STATS_REACH / camera.get_zoom();
+      for (size_t b = 0; b < bodies.size(); b++) {
+        if (!shows_detail(world, bodies.radius[b])) continue;     // Too Small to Read
+        draw_force_on_body(world, bodies, b, Vector2D{ state.force_x[b], state.force_y[b] });
+        if (camera.is_visible(bodies.x[b], bodies.y[b], bodies.radius[b] + stats_reach))
+          draw_body_stats(world, bodies, b);
+      }
     }
 };
 
 
 
+/**
+ * Renders frames without a window when started with
+ *  `--offscreen WIDTHxHEIGHT [FRAMES] [PNG_PATH] [RECORD_PATH]`. Every frame
+ *  is recorded to RECORD_PATH if given (.y4m, .rgba or a PNG prefix).
+ *
+ * @return Exit code, or -1 if not requested
+ */
+static int run_offscreen(int argc, char *argv[]) {
+  if (argc < 3 || strcmp(argv[1], "--offscreen") != 0) return -1;
+
+  int width, height;
+  if (sscanf(argv[2], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+    fprintf(stderr, "Usage: %s --offscreen WIDTHxHEIGHT [FRAMES] [PNG_PATH] [RECORD_PATH]\n", argv[0]);
+    return 1;
+  }
+  size_t frames = argc > 3 ? strtoull(argv[3], nullptr, 10) : 600;
+  std::string png_path = argc > 4 ? argv[4] : "";
+  std::string record_path = argc > 5 ? argv[5] : "";
+
+  // No display needed, only the GTK/gtkmm type system.
+  gtk_init_check(NULL, NULL);
+  Gtk::Main::init_gtkmm_internals();
+
+  MyApp my_app;
+  if (!record_path.empty())
+    my_app.start_recording(record_path);
+  my_app.render_offscreen(width, height, frames, png_path);
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
+  // OFFSCREEN RENDERING
+  int offscreen_result = run_offscreen(argc, argv);
+  if (offscreen_result >= 0)
+    return offscreen_result;
+
   // START WINDOW + APP
   auto gtk_application = Gtk::Application::create(argc, argv, "org.gtkmm.sandbox.base");
   MyApp my_app;